@@ -155,6 +155,54 @@ public:
     void DisableUSART(unsigned index) { ASSERT(index < USART_COUNT); EFM32_BITCLR(HFPERCLKEN0, CMU_HFPERCLKEN0_USART0 << index); }
 #endif
 
+#ifdef CMU_HFPERCLKEN0_UART0
+    bool UARTEnabled(unsigned index) { ASSERT(index < UART_COUNT); return HFPERCLKEN0 & UARTMask(index); }
+    void EnableUART(unsigned index) { ASSERT(index < UART_COUNT); EFM32_BITSET(HFPERCLKEN0, UARTMask(index)); }
+    void DisableUART(unsigned index) { ASSERT(index < UART_COUNT); EFM32_BITCLR(HFPERCLKEN0, UARTMask(index)); }
+    static constexpr uint32_t UARTMask(unsigned index) { return index ? CMU_HFPERCLKEN0_UART1 : CMU_HFPERCLKEN0_UART0; }
+#endif
+
+#ifdef CMU_LFBCLKEN0_LEUART0
+    bool LEUARTEnabled(unsigned index) { ASSERT(index < LEUART_COUNT); return LFBCLKEN0 & LEUARTMask(index); }
+    void EnableLEUART(unsigned index) { ASSERT(index < LEUART_COUNT); while (SYNCBUSY & CMU_SYNCBUSY_LFBCLKEN0); EFM32_BITSET(LFBCLKEN0, LEUARTMask(index)); }
+    void DisableLEUART(unsigned index) { ASSERT(index < LEUART_COUNT); while (SYNCBUSY & CMU_SYNCBUSY_LFBCLKEN0); EFM32_BITCLR(LFBCLKEN0, LEUARTMask(index)); }
+#if LEUART_COUNT > 1
+    static constexpr uint32_t LEUARTMask(unsigned index) { return index ? CMU_LFBCLKEN0_LEUART1 : CMU_LFBCLKEN0_LEUART0; }
+#else
+    static constexpr uint32_t LEUARTMask(unsigned index) { return CMU_LFBCLKEN0_LEUART0; }
+#endif
+    //! Gets the frequency of the LFB clock feeding the LEUARTs, according to the selected source
+    unsigned GetLFBFrequency() const
+    {
+        switch (LFBCLKSEL & _CMU_LFBCLKSEL_LFB_MASK)
+        {
+        case CMU_LFBCLKSEL_LFB_LFRCO:
+        case CMU_LFBCLKSEL_LFB_LFXO:
+            return 32768;
+#ifdef CMU_LFBCLKSEL_LFB_ULFRCO
+        case CMU_LFBCLKSEL_LFB_ULFRCO:
+            return 1000;
+#endif
+        case CMU_LFBCLKSEL_LFB_HFCLKLE:
+            return GetCoreFrequency() / ((HFPRESC & _CMU_HFPRESC_HFCLKLEPRESC_MASK) == CMU_HFPRESC_HFCLKLEPRESC_DIV4 ? 4 : 2);
+        default:
+            return 0;
+        }
+    }
+    //! Gets the frequency of the specified LEUART, i.e. the LFB clock after its prescaler
+    unsigned GetLEUARTFrequency(unsigned index) const
+    {
+        ASSERT(index < LEUART_COUNT);
+#if LEUART_COUNT > 1
+        if (index)
+        {
+            return GetLFBFrequency() >> ((LFBPRESC0 & _CMU_LFBPRESC0_LEUART1_MASK) >> _CMU_LFBPRESC0_LEUART1_SHIFT);
+        }
+#endif
+        return GetLFBFrequency() >> ((LFBPRESC0 & _CMU_LFBPRESC0_LEUART0_MASK) >> _CMU_LFBPRESC0_LEUART0_SHIFT);
+    }
+#endif
+
 #ifdef CMU_HFBUSCLKEN0_USB
     bool USBEnabled() { return HFBUSCLKEN0 & CMU_HFBUSCLKEN0_USB; }
     void EnableUSB()
@@ -183,6 +231,12 @@ public:
     void EnableLDMA() { EFM32_BITSET(HFBUSCLKEN0, CMU_HFBUSCLKEN0_LDMA); }
 #endif
 
+#ifdef CMU_HFBUSCLKEN0_QSPI0
+    bool QSPIEnabled() { return HFBUSCLKEN0 & CMU_HFBUSCLKEN0_QSPI0; }
+    void EnableQSPI() { EFM32_BITSET(HFBUSCLKEN0, CMU_HFBUSCLKEN0_QSPI0); }
+    void DisableQSPI() { EFM32_BITCLR(HFBUSCLKEN0, CMU_HFBUSCLKEN0_QSPI0); }
+#endif
+
 #ifdef CMU_HFBUSCLKEN0_GPCRC
     bool GPCRCEnabled() { return HFBUSCLKEN0 & CMU_HFBUSCLKEN0_GPCRC; }
     void EnableGPCRC() { EFM32_BITSET(HFBUSCLKEN0, CMU_HFBUSCLKEN0_GPCRC); }
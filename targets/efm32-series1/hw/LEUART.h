@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/hw/LEUART.h
+ */
+
+#pragma once
+
+#include <kernel/kernel.h>
+
+#include <hw/CMU.h>
+#include <hw/GPIO.h>
+
+#ifdef LEUART0_BASE
+#undef LEUART0
+#define LEUART0	CM_PERIPHERAL(LEUART, LEUART0_BASE)
+#endif
+
+#ifdef LEUART1_BASE
+#undef LEUART1
+#define LEUART1	CM_PERIPHERAL(LEUART, LEUART1_BASE)
+#endif
+
+//! Low energy UART, clocked from the LFB clock and able to receive in EM2
+class LEUART : public LEUART_TypeDef
+{
+public:
+    enum Flags
+    {
+        AutoTxTristate = LEUART_CTRL_AUTOTRI,
+
+        DataBits8 = LEUART_CTRL_DATABITS_EIGHT,
+        DataBits9 = LEUART_CTRL_DATABITS_NINE,
+
+        ParityNone = LEUART_CTRL_PARITY_NONE,
+        ParityEven = LEUART_CTRL_PARITY_EVEN,
+        ParityOdd = LEUART_CTRL_PARITY_ODD,
+
+        StopBitsOne = LEUART_CTRL_STOPBITS_ONE,
+        StopBitsTwo = LEUART_CTRL_STOPBITS_TWO,
+
+        Invert = LEUART_CTRL_INV,
+        StopDMAOnError = LEUART_CTRL_ERRSDMA,
+        Loopback = LEUART_CTRL_LOOPBK,
+        StartFrameUnblocksRx = LEUART_CTRL_SFUBRX,
+        MultiProcessorMode = LEUART_CTRL_MPM,
+
+        //! Keeps the LDMA serving RX requests in EM2
+        RxDMAWakeup = LEUART_CTRL_RXDMAWU,
+        //! Keeps the LDMA serving TX requests in EM2
+        TxDMAWakeup = LEUART_CTRL_TXDMAWU,
+    };
+
+    //! Gets the index of the LEUART peripheral
+    unsigned Index() const { return ((unsigned)this - LEUART0_BASE) >> 10; }
+
+    //! Enables the clock to the LEUART peripheral
+    void EnableClock() { CMU->EnableLEUART(Index()); }
+    //! Disables the clock to the LEUART peripheral
+    void DisableClock() { CMU->DisableLEUART(Index()); }
+    //! Gets the clock frequency of the LEUART peripheral
+    unsigned ClockFrequency() const { return CMU->GetLEUARTFrequency(Index()); }
+
+    //! Gets the IRQ number
+    IRQn_Type IRQn() const { return (IRQn_Type)BYTES(LEUART0_IRQn
+#if LEUART_COUNT > 1
+        , LEUART1_IRQn
+#endif
+        )[Index()]; }
+
+    //! Waits until all previous register writes are synchronized to the low frequency domain
+    void Sync() const { while (SYNCBUSY); }
+
+    //! Configures the LEUART peripheral
+    void Setup(Flags flags) { Sync(); CTRL = flags; }
+    //! Sets the specified configuration flags
+    void Set(Flags flags) { Sync(); CTRL |= flags; }
+    //! Clears the specified configuration flags
+    void Clear(Flags flags) { Sync(); CTRL &= ~flags; }
+    //! Sets the baud rate
+    void BaudRate(unsigned baudRate) { Sync(); CLKDIV = (((ClockFrequency() << 8) / baudRate) - 256) & _LEUART_CLKDIV_DIV_MASK; }
+    //! Gets the baud rate
+    unsigned BaudRate() const { return (ClockFrequency() << 8) / (CLKDIV + 256); }
+    //! Sets the signal frame, which raises the SIGF interrupt when received
+    void SignalFrame(uint8_t frame) { Sync(); SIGFRAME = frame; }
+
+    //! Enables data reception
+    void RxEnable() { Sync(); CMD = LEUART_CMD_RXEN; }
+    //! Disables data reception
+    void RxDisable() { Sync(); CMD = LEUART_CMD_RXDIS; }
+    //! Enables data transmission
+    void TxEnable() { Sync(); CMD = LEUART_CMD_TXEN; }
+    //! Disables data transmission
+    void TxDisable() { Sync(); CMD = LEUART_CMD_TXDIS; }
+    //! Clears the receive buffer
+    void RxClear() { Sync(); CMD = LEUART_CMD_CLEARRX; }
+
+    //! Checks if there is valid data in the receive buffer
+    bool RxValid() const { return STATUS & LEUART_STATUS_RXDATAV; }
+    //! Checks if data can be written to the transmit buffer
+    bool TxFree() const { return STATUS & LEUART_STATUS_TXBL; }
+    //! Checks if the transmission is completed
+    bool TxComplete() const { return STATUS & LEUART_STATUS_TXC; }
+
+#ifdef EFM32_GPIO_LINEAR_INDEX
+    //! Configures the RX pin
+    void ConfigureRx(GPIOPin pin, GPIOPin::Mode mode = GPIOPin::Input) { pin.ConfigureAlternate(mode, ROUTEPEN, 0, 1u); }
+    //! Configures the TX pin
+    void ConfigureTx(GPIOPin pin, GPIOPin::Mode mode = GPIOPin::PushPull) { pin.ConfigureAlternate(mode, ROUTEPEN, 1, 0u); }
+#else
+    //! Configures the RX pin at the specified location (see the datasheet)
+    void ConfigureRx(GPIOPin pin, unsigned location, GPIOPin::Mode mode = GPIOPin::Input)
+    {
+        pin.Configure(mode);
+        MODMASK(ROUTELOC0, _LEUART_ROUTELOC0_RXLOC_MASK, location << _LEUART_ROUTELOC0_RXLOC_SHIFT);
+        ROUTEPEN |= LEUART_ROUTEPEN_RXPEN;
+    }
+    //! Configures the TX pin at the specified location (see the datasheet)
+    void ConfigureTx(GPIOPin pin, unsigned location, GPIOPin::Mode mode = GPIOPin::PushPull)
+    {
+        pin.Configure(mode);
+        MODMASK(ROUTELOC0, _LEUART_ROUTELOC0_TXLOC_MASK, location << _LEUART_ROUTELOC0_TXLOC_SHIFT);
+        ROUTEPEN |= LEUART_ROUTEPEN_TXPEN;
+    }
+#endif
+};
+
+DEFINE_FLAG_ENUM(LEUART::Flags);
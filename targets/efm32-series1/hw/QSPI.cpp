@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/hw/QSPI.cpp
+ */
+
+#include <base/base.h>
+
+#if QSPI_COUNT
+
+#include <hw/QSPI.h>
+
+#define MYDBG(...)  DBGCL("QSPI", __VA_ARGS__)
+
+void _QSPI::Setup(unsigned divisor)
+{
+    CMU->EnableQSPI();
+
+    QSPI_Init_TypeDef init = QSPI_INIT_DEFAULT;
+    init.divisor = divisor;
+    QSPI_Init(this, &init);
+    MYDBG("Enabled, SCLK = REFCLK / %d", divisor);
+}
+
+void _QSPI::Route(unsigned location, unsigned dataLines, bool cs1)
+{
+    ASSERT(dataLines == 1 || dataLines == 2 || dataLines == 4 || dataLines == 8);
+    ROUTELOC0 = location << _QSPI_ROUTELOC0_QSPILOC_SHIFT;
+    // DQ0..DQn are consecutive bits in ROUTEPEN
+    ROUTEPEN = QSPI_ROUTEPEN_SCLKPEN | QSPI_ROUTEPEN_CS0PEN | (cs1 ? QSPI_ROUTEPEN_CS1PEN : 0) |
+        ((BIT(dataLines) - 1) * QSPI_ROUTEPEN_DQ0PEN);
+}
+
+void _QSPI::ReadMode(uint8_t opcode, unsigned dummyCycles, Lines instruction, Lines address, Lines data)
+{
+    QSPI_ReadConfig_TypeDef cfg = {};
+    cfg.opCode = opcode;
+    cfg.dummyCycles = dummyCycles;
+    cfg.instTransfer = (QSPI_TransferType_TypeDef)instruction;
+    cfg.addrTransfer = (QSPI_TransferType_TypeDef)address;
+    cfg.dataTransfer = (QSPI_TransferType_TypeDef)data;
+    QSPI_ReadConfig(this, &cfg);
+}
+
+void _QSPI::WriteMode(uint8_t opcode, Lines address, Lines data)
+{
+    QSPI_WriteConfig_TypeDef cfg = {};
+    cfg.opCode = opcode;
+    cfg.addrTransfer = (QSPI_TransferType_TypeDef)address;
+    cfg.dataTransfer = (QSPI_TransferType_TypeDef)data;
+    cfg.autoWEL = true;
+    QSPI_WriteConfig(this, &cfg);
+}
+
+void _QSPI::Command(uint8_t opcode, Span tx, Buffer rx, uint32_t address, unsigned addressBytes, unsigned dummyCycles)
+{
+    // STIG transfers at most 8 bytes in each direction
+    ASSERT(tx.Length() <= 8 && rx.Length() <= 8);
+
+    QSPI_StigCmd_TypeDef cmd = {};
+    cmd.cmdOpcode = opcode;
+    cmd.addrSize = addressBytes;
+    cmd.address = address;
+    cmd.dummyCycles = dummyCycles;
+    cmd.writeDataSize = tx.Length();
+    cmd.writeBuffer = (void*)tx.Pointer();
+    cmd.readDataSize = rx.Length();
+    cmd.readBuffer = rx.Pointer();
+    QSPI_ExecStigCmd(this, &cmd);
+}
+
+async(QSPIFlash::Write, uint32_t address, Span data)
+async_def()
+{
+    // memory-mapped writes issue program commands and wait for completion in the controller
+    await(dma.Copy, qspi.Window(address), data.Pointer(), data.Length());
+    async_return(await(WaitReady));
+}
+async_end
+
+async(QSPIFlash::Erase, uint32_t address, uint8_t opcode, unsigned addressBytes)
+async_def()
+{
+    MYDBG("Erase %02X @ %08X", opcode, address);
+    qspi.Command(CmdWriteEnable);
+    qspi.Command(opcode, Span(), Buffer(), address, addressBytes);
+    // larger erases take proportionally longer, no point checking them as often
+    async_return(await(WaitReady, ~0u, opcode == CmdChipErase ? 100 : opcode == CmdBlockErase ? 10 : 1));
+}
+async_end
+
+async(QSPIFlash::Poll, uint8_t opcode, uint8_t mask, uint8_t value, size_t maxBatches, unsigned timeoutMs, unsigned intervalMs)
+async_def(
+    uint8_t status[8];
+    mono_t start;
+)
+{
+    f.start = MONO_CLOCKS;
+
+    while (maxBatches--)
+    {
+        qspi.Command(opcode, Span(), Buffer(f.status, sizeof(f.status)));
+
+        if ((f.status[sizeof(f.status) - 1] & mask) == value)
+        {
+            async_return(true);
+        }
+
+        if (timeoutMs != ~0u && MONO_CLOCKS - f.start >= MonoFromMilliseconds(timeoutMs))
+        {
+            break;
+        }
+
+        // STIG commands are synchronous, always give the other tasks a chance to run
+        async_delay_ms(std::max(intervalMs, 1u));
+    }
+
+    async_return(false);
+}
+async_end
+
+async(QSPIFlash::EnableQuad, uint8_t readOpcode, uint8_t writeOpcode, uint8_t bit)
+async_def(
+    uint8_t status;
+)
+{
+    qspi.Command(readOpcode, Span(), Buffer(&f.status, 1));
+    if (f.status & bit)
+    {
+        async_return(true);
+    }
+
+    MYDBG("Setting QE, status %02X", f.status);
+    f.status |= bit;
+    qspi.Command(CmdWriteEnable);
+    qspi.Command(writeOpcode, Span(&f.status, 1));
+    if (!await(WaitReady, 100))
+    {
+        async_return(false);
+    }
+
+    qspi.Command(readOpcode, Span(), Buffer(&f.status, 1));
+    async_return(!!(f.status & bit));
+}
+async_end
+
+async(QSPIFlash::QuadMode, unsigned dummyCycles)
+async_def()
+{
+    if (!await(EnableQuad))
+    {
+        MYDBG("Failed to set QE");
+        async_return(false);
+    }
+
+    qspi.ReadMode(CmdQuadOutputRead, dummyCycles, _QSPI::Lines::Single, _QSPI::Lines::Single, _QSPI::Lines::Quad);
+    qspi.WriteMode(CmdQuadPageProgram, _QSPI::Lines::Single, _QSPI::Lines::Quad);
+    async_return(true);
+}
+async_end
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/hw/QSPI.h
+ */
+
+#pragma once
+
+#include <kernel/kernel.h>
+
+#include <base/Span.h>
+
+#if QSPI_COUNT
+
+#include <hw/CMU.h>
+#include <hw/LDMAMemory.h>
+
+#include <em_qspi.h>
+
+#undef QSPI0
+#define QSPI0   CM_PERIPHERAL(_QSPI, QSPI0_BASE)
+
+//! Register-level access to the QSPI controller, using emlib for the more complex sequences
+class _QSPI : public QSPI_TypeDef
+{
+public:
+    //! Number of data lines used for a phase of a command
+    enum struct Lines
+    {
+        Single = qspiTransferSingle,
+        Dual = qspiTransferDual,
+        Quad = qspiTransferQuad,
+        Octal = qspiTransferOctal,
+    };
+
+    //! Enables the clock and the controller
+    //! @param divisor Divisor of the reference clock used to generate SCLK (2 to 32)
+    void Setup(unsigned divisor = 2);
+    //! Routes the signals to the specified location
+    //! @param dataLines Number of data lines to enable (1, 2, 4 or 8)
+    void Route(unsigned location, unsigned dataLines, bool cs1 = false);
+
+    //! Configures the command used for memory-mapped reads
+    void ReadMode(uint8_t opcode, unsigned dummyCycles, Lines instruction, Lines address, Lines data);
+    //! Configures the command used for memory-mapped writes, write enable is sent automatically
+    void WriteMode(uint8_t opcode, Lines address, Lines data);
+    //! Configures the number of address bytes used for memory-mapped access
+    void AddressBytes(unsigned bytes) { MODMASK(DEVSIZECONFIG, _QSPI_DEVSIZECONFIG_NUMADDRBYTES_MASK, (bytes - 1) << _QSPI_DEVSIZECONFIG_NUMADDRBYTES_SHIFT); }
+
+    //! Executes a command using the STIG (software triggered instruction generator)
+    //! @param addressBytes Number of address bytes sent, 0 for no address
+    void Command(uint8_t opcode, Span tx = Span(), Buffer rx = Buffer(), uint32_t address = 0, unsigned addressBytes = 0, unsigned dummyCycles = 0);
+
+    //! Checks if the controller is idle
+    bool IsIdle() const { return CONFIG & QSPI_CONFIG_IDLE; }
+
+    //! Gets a pointer to the memory-mapped window (direct access)
+    static uint8_t* Window(uint32_t address = 0) { return (uint8_t*)QSPI0_MEM_BASE + address; }
+#ifdef QSPI0_CODE_MEM_BASE
+    //! Gets a pointer to the memory-mapped window in the code area, suitable for execute-in-place
+    static const uint8_t* CodeWindow(uint32_t address = 0) { return (const uint8_t*)QSPI0_CODE_MEM_BASE + address; }
+#endif
+};
+
+/*!
+ * Asynchronous access to a (NOR) flash connected to the QSPI controller
+ *
+ * Reads and writes go through the direct access window and are performed
+ * by the LDMA, erase and status polling use STIG commands. The controller
+ * polls the write-in-progress bit after memory-mapped writes by itself.
+ *
+ * The interface does not mirror the descriptor chains of @ref bus::SPI,
+ * the controller generates the chip select and the command framing itself,
+ * so there is no bus to acquire and no raw transfer to describe. What maps
+ * directly is kept the same, i.e. @ref Poll follows @ref bus::SPI::Poll.
+ */
+class QSPIFlash
+{
+public:
+    QSPIFlash(_QSPI& qspi, LDMAMemory& dma)
+        : qspi(qspi), dma(dma) {}
+    QSPIFlash(_QSPI* qspi, LDMAMemory& dma)
+        : qspi(*qspi), dma(dma) {}
+
+    enum
+    {
+        CmdWriteEnable = 0x06,
+        CmdReadStatus = 0x05,
+        CmdReadStatus2 = 0x35,
+        CmdWriteStatus2 = 0x31,
+        CmdSectorErase = 0x20,
+        CmdBlockErase = 0xD8,
+        CmdChipErase = 0xC7,
+        CmdQuadOutputRead = 0x6B,
+        CmdQuadPageProgram = 0x32,
+
+        StatusWriteInProgress = 1,
+        Status2QuadEnable = 2,
+    };
+
+    //! Reads data from the flash
+    async(Read, uint32_t address, Buffer data) { return async_forward(dma.Copy, data.Pointer(), qspi.Window(address), data.Length()); }
+    //! Writes data to previously erased flash
+    async(Write, uint32_t address, Span data);
+    //! Erases the sector/block containing the specified address
+    async(Erase, uint32_t address, uint8_t opcode = CmdSectorErase, unsigned addressBytes = 3);
+    //! Executes an arbitrary command
+    async(Command, uint8_t opcode, Span tx = Span(), Buffer rx = Buffer()) async_def_sync() { qspi.Command(opcode, tx, rx); async_return(true); } async_end
+    /*!
+     * Polls a status register until (status & mask) == value
+     *
+     * Each batch is a single STIG command clocking in as many status bytes
+     * as the controller can hold, flash streams the status register
+     * continuously while CS is held, only the last byte is checked.
+     *
+     * @returns true if the status matched, false if @p maxBatches or @p timeoutMs was exhausted
+     */
+    async(Poll, uint8_t opcode, uint8_t mask, uint8_t value, size_t maxBatches = ~0u, unsigned timeoutMs = ~0u, unsigned intervalMs = 1);
+    //! Waits until the flash finishes the operation in progress
+    async(WaitReady, unsigned timeoutMs = ~0u, unsigned intervalMs = 1) { return async_forward(Poll, CmdReadStatus, StatusWriteInProgress, 0, ~0u, timeoutMs, intervalMs); }
+
+    /*!
+     * Sets the non-volatile Quad Enable bit of the flash, which turns
+     * the WP# and HOLD# pins into IO2 and IO3
+     *
+     * Must be done before any quad command is issued. The defaults match
+     * the common layout with QE in bit 1 of the second status register
+     * (Winbond, GigaDevice), other parts can override the commands and bit.
+     */
+    async(EnableQuad, uint8_t readOpcode = CmdReadStatus2, uint8_t writeOpcode = CmdWriteStatus2, uint8_t bit = Status2QuadEnable);
+    //! Enables quad mode in the flash and configures the controller for quad output reads and quad page programs
+    async(QuadMode, unsigned dummyCycles = 8);
+
+private:
+    _QSPI& qspi;
+    LDMAMemory& dma;
+
+    uint8_t ReadStatus() { uint8_t status; qspi.Command(CmdReadStatus, Span(), Buffer(&status, 1)); return status; }
+};
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/hw/UART.h
+ */
+
+#pragma once
+
+#include <hw/USART.h>
+
+#if UART_COUNT
+
+#undef UART0
+#define UART0	CM_PERIPHERAL(UART, UART0_BASE)
+
+#undef UART1
+#define UART1	CM_PERIPHERAL(UART, UART1_BASE)
+
+/*!
+ * Asynchronous-only UART found on some parts (e.g. GG11)
+ *
+ * The register layout is identical to the USART, only the peripheral
+ * index, clock gate, interrupts and pin locations differ.
+ *
+ * @note USART::Index is not virtual, every inherited member that depends
+ * on it is either redefined here or made inaccessible, as are the
+ * synchronous mode members the UART does not support
+ */
+class UART : public USART
+{
+public:
+    //! Gets the index of the UART peripheral
+    unsigned Index() const { return ((unsigned)this - UART0_BASE) >> 10; }
+
+    //! Sets the baud rate and appropriate oversampling
+    void BaudRate(unsigned baudRate) { USART::BaudRate(baudRate, "UART", Index()); }
+    //! Gets the baud rate
+    unsigned BaudRate() { return USART::BaudRate(); }
+
+    //! Enables the clock to the UART peripheral
+    void EnableClock() { CMU->EnableUART(Index()); }
+    //! Disables the clock to the UART peripheral
+    void DisableClock() { CMU->DisableUART(Index()); }
+
+    //! Gets the RX IRQ number
+    IRQn_Type RxIRQn() const { return (IRQn_Type)BYTES(UART0_RX_IRQn, UART1_RX_IRQn)[Index()]; }
+    //! Gets the TX IRQ number
+    IRQn_Type TxIRQn() const { return (IRQn_Type)(RxIRQn() + 1); }
+
+    //! Configures the RX pin at the specified location (see the datasheet)
+    void ConfigureRx(GPIOPin pin, unsigned location, GPIOPin::Mode mode = GPIOPin::Input)
+    {
+        pin.Configure(mode);
+        MODMASK(ROUTELOC0, _USART_ROUTELOC0_RXLOC_MASK, location << _USART_ROUTELOC0_RXLOC_SHIFT);
+        ROUTEPEN |= USART_ROUTEPEN_RXPEN;
+    }
+    //! Configures the TX pin at the specified location (see the datasheet)
+    void ConfigureTx(GPIOPin pin, unsigned location, GPIOPin::Mode mode = GPIOPin::PushPull)
+    {
+        pin.Configure(mode);
+        MODMASK(ROUTELOC0, _USART_ROUTELOC0_TXLOC_MASK, location << _USART_ROUTELOC0_TXLOC_SHIFT);
+        ROUTEPEN |= USART_ROUTEPEN_TXPEN;
+    }
+    //! Configures the CTS pin at the specified location (see the datasheet)
+    void ConfigureCts(GPIOPin pin, unsigned location, GPIOPin::Mode mode = GPIOPin::Input)
+    {
+        pin.Configure(mode);
+        MODMASK(ROUTELOC1, _USART_ROUTELOC1_CTSLOC_MASK, location << _USART_ROUTELOC1_CTSLOC_SHIFT);
+        ROUTEPEN |= USART_ROUTEPEN_CTSPEN;
+    }
+    //! Configures the RTS pin at the specified location (see the datasheet)
+    void ConfigureRts(GPIOPin pin, unsigned location, GPIOPin::Mode mode = GPIOPin::PushPull)
+    {
+        pin.Configure(mode);
+        MODMASK(ROUTELOC1, _USART_ROUTELOC1_RTSLOC_MASK, location << _USART_ROUTELOC1_RTSLOC_SHIFT);
+        ROUTEPEN |= USART_ROUTEPEN_RTSPEN;
+    }
+
+private:
+    // the USART pin location tables and the synchronous mode do not apply to the UART
+    using USART::ConfigureRx;
+    using USART::ConfigureTx;
+    using USART::ConfigureCs;
+    using USART::ConfigureClk;
+    using USART::ConfigureCts;
+    using USART::ConfigureRts;
+    using USART::GetCsLocation;
+    using USART::BindCs;
+    using USART::ReleaseCs;
+    using USART::BeginSyncBidirectionalTransfer;
+    using USART::SyncBidirectionalTransfer;
+    using USART::BeginSyncTransfer;
+    using USART::SyncTransfer;
+    using USART::SyncTransferSingle;
+};
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/io/LEUARTRxPipe.h
+ */
+
+#pragma once
+
+//! @file
+//! The pipe is implemented by the shared @ref io::SerialRxPipe template
+#include <io/SerialRxPipe.h>
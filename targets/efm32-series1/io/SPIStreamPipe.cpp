@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/io/SPIStreamPipe.cpp
+ */
+
+#include "SPIStreamPipe.h"
+
+//#define SPI_STREAM_TRACE    1
+
+#define MYDBG(fmt, ...)    DBGL("USART%d_SPI: " fmt, usart.Index(), ## __VA_ARGS__)
+
+#if SPI_STREAM_TRACE
+#define MYTRACE MYDBG
+#else
+#define MYTRACE(...)
+#endif
+
+namespace io
+{
+
+async(SPIStreamPipe::Start)
+async_def_sync()
+{
+    if (running)
+    {
+        async_return(true);
+    }
+
+    running = rxRunning = txRunning = true;
+    MYDBG("Starting %s", slave ? "slave" : "master");
+    PLATFORM_DEEP_SLEEP_DISABLE();
+
+    if (!triggered)
+    {
+        txDma = LDMA->GetUSARTChannel(usart.Index(), LDMAChannel::USARTSignal::TxFree, false);
+    }
+    auto rxDma = LDMA->GetUSARTChannel(usart.Index(), LDMAChannel::USARTSignal::RxDataValid, false, LDMAChannel::Priority::RealTime);
+
+    ASSERT(usart.RxEmpty());
+    ring.Start(rxDma, &usart.RXDATA, ringBuffer, LDMADescriptor::UnitByte | LDMADescriptor::SetDone);
+
+    // the filler loops forever, data descriptors are spliced in by Redirect
+    fillerDesc.SetTransfer(&filler, &usart.TXDATA, SPI_STREAM_FILLER_BLOCK,
+        LDMADescriptor::P2P | LDMADescriptor::UnitByte | txBlock, LDMALink::Self);
+    txDma.LinkLoad(fillerDesc);
+
+    if (slave)
+    {
+        usart.MasterDisable();
+    }
+    else
+    {
+        usart.MasterEnable();
+    }
+    usart.BidirectionalEnable();
+
+    kernel::Task::Run(this, &SPIStreamPipe::RxTask);
+    kernel::Task::Run(this, &SPIStreamPipe::TxTask);
+    async_return(true);
+}
+async_end
+
+async(SPIStreamPipe::Stop, Timeout timeout)
+async_def(
+    Timeout timeout;
+)
+{
+    if (!running)
+    {
+        async_return(true);
+    }
+
+    f.timeout = timeout.MakeAbsolute();
+    MYDBG("Stopping");
+    running = false;
+    // wake up both tasks
+    txDma.Disable();
+    txDma.SetDone();
+    ring.Channel().SetDone();
+
+    if (!await_signal_off_timeout(rxRunning, f.timeout) ||
+        !await_signal_off_timeout(txRunning, f.timeout))
+    {
+        MYDBG("Failed to stop");
+        async_return(false);
+    }
+
+    async_return(true);
+}
+async_end
+
+async(SPIStreamPipe::RxTask)
+async_def()
+{
+    while (running && !pipe.IsClosed())
+    {
+        while (ring.Available().Length())
+        {
+            if (!pipe.Available() && !await(pipe.Allocate, blockSize))
+            {
+                break;
+            }
+
+            auto data = ring.Available();
+            auto buf = pipe.GetBuffer();
+            size_t count = std::min(data.Length(), buf.Length());
+            memcpy(buf.Pointer(), data.Pointer(), count);
+            MYTRACE("<< %H", buf.Left(count));
+            pipe.Advance(count);
+            ring.Consume(count);
+        }
+
+        if (pipe.IsClosed())
+        {
+            break;
+        }
+
+        // woken up only when one half of the ring is filled
+        await(LDMA->WaitForDoneMask, BIT(ring.Channel()));
+    }
+
+    MYDBG("RX finished");
+    running = false;
+    usart.BidirectionalDisable();
+    ring.Stop();
+    ring.Channel().Release();
+    PLATFORM_DEEP_SLEEP_ENABLE();
+    rxRunning = false;
+}
+async_end
+
+async(SPIStreamPipe::TxTask)
+async_def(
+    size_t length;
+)
+{
+    while (txPipe && running && await(txPipe->Require))
+    {
+        if (!running)
+        {
+            break;
+        }
+
+        {
+            auto span = txPipe->GetSpan();
+            f.length = std::min(span.Length(), size_t(LDMADescriptor::MaximumTransferSize));
+            dataDesc.SetTransfer(span.Pointer(), &usart.TXDATA, f.length,
+                LDMADescriptor::M2P | LDMADescriptor::UnitByte | LDMADescriptor::SetDone | txBlock, &fillerDesc);
+            MYTRACE(">> %H", span.Left(f.length));
+        }
+
+        Redirect();
+        await(LDMA->WaitForDoneMask, BIT(txDma));
+        txPipe->Advance(f.length);
+    }
+
+    // without a transmit pipe, the filler keeps running until the stream is stopped
+    await_signal_off(running);
+
+    MYDBG("TX finished");
+    txDma.Disable();
+    if (!triggered)
+    {
+        txDma.Release();
+    }
+    txRunning = false;
+}
+async_end
+
+/*!
+ * Switches the transmit channel from the filler to the data descriptor
+ *
+ * The channel is always executing the filler when this is called, its
+ * link in memory is never modified, only the LINK register of the running
+ * channel, so the channel returns to the filler after the data descriptor.
+ */
+void SPIStreamPipe::Redirect()
+{
+    txDma.RequestsDisable();
+    while (txDma.IsBusy());
+    txDma.RootDescriptor().Link(&dataDesc);
+    txDma.RequestsEnable();
+}
+
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/io/SPIStreamPipe.h
+ */
+
+#pragma once
+
+#include <io/io.h>
+
+#include <hw/LDMA.h>
+#include <hw/USART.h>
+
+#ifndef SPI_STREAM_FILLER_BLOCK
+//! Number of filler frames transmitted by one pass of the filler descriptor,
+//! limits the latency of switching to data from the transmit pipe
+#define SPI_STREAM_FILLER_BLOCK     16
+#endif
+
+namespace io
+{
+
+/*!
+ * Continuous full-duplex SPI stream
+ *
+ * Received frames are captured by an LDMARing and copied into the PipeWriter
+ * every time one half of the ring fills up. Transmitted frames come from an
+ * optional PipeReader, a constant filler is transmitted whenever there is
+ * no data to send, so the clock never stops in master mode.
+ *
+ * In master mode the transmit channel can be paced by a TIMER or PRS
+ * request instead of the USART TX buffer, producing frames at a fixed rate.
+ * In slave mode the filler merely keeps the TX buffer loaded.
+ */
+class SPIStreamPipe
+{
+public:
+    //! Creates a stream receiving into the specified pipe via the specified ring buffer
+    SPIStreamPipe(USART& usart, PipeWriter pipe, Buffer ring, size_t blockSize = 256)
+        : usart(usart), pipe(pipe), ringBuffer(ring), blockSize(blockSize)
+    {
+    }
+
+    USART& GetUSART() const { return usart; }
+
+    //! Transmits data from the specified pipe instead of the filler, must be called before @ref Start
+    //! @note The stream stops transmitting only after the reader is closed
+    void TransmitFrom(PipeReader& reader) { txPipe = &reader; }
+    //! Sets the value transmitted when there is no data to send
+    void Filler(uint8_t value) { filler = value; }
+    //! Paces transmitted frames using the specified channel, allocated e.g. using
+    //! LDMAController::GetTIMERChannel or LDMAController::GetPRSChannel, must be called before @ref Start
+    //! @param block Number of frames transmitted per request (one of the LDMADescriptor::BlockSize* flags)
+    //! @note The trigger period must be longer than the duration of the frames transmitted per request
+    void Trigger(LDMAChannelHandle dma, LDMADescriptor::Flags block = LDMADescriptor::BlockSize1) { txDma = dma; txBlock = block; triggered = true; }
+    //! Operates the USART in slave mode
+    void Slave(bool slave = true) { this->slave = slave; }
+
+    async(Start);
+    async(Stop, Timeout timeout = Timeout::Infinite);
+
+private:
+    USART& usart;
+    PipeWriter pipe;
+    PipeReader* txPipe = NULL;
+    Buffer ringBuffer;
+    size_t blockSize;
+    LDMARing ring;
+    LDMAChannelHandle txDma;
+    LDMADescriptor::Flags txBlock = LDMADescriptor::BlockSize1;
+    LDMADescriptor fillerDesc, dataDesc;
+    uint8_t filler = 0;
+    bool slave = false;
+    bool triggered = false;
+    bool running = false, rxRunning = false, txRunning = false;
+
+    async(RxTask);
+    async(TxTask);
+
+    void Redirect();
+};
+
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/io/SerialPipeTraits.h
+ */
+
+#pragma once
+
+#include <kernel/kernel.h>
+
+#include <hw/LDMA.h>
+#include <hw/USART.h>
+#include <hw/UART.h>
+#include <hw/LEUART.h>
+
+namespace io
+{
+
+/*!
+ * Describes how the serial pipes drive a specific peripheral type
+ *
+ * Besides the members below, the peripheral class has to provide
+ * Index(), RxEnable(), RxDisable(), TxEnable(), TxDisable(), TxComplete()
+ * and the RXDATA/TXDATA/IEN registers
+ */
+template<class TPeripheral> struct SerialPipeTraits;
+
+//! Common traits of the USART and UART peripherals, which share the register layout
+template<class TPeripheral> struct USARTPipeTraitsBase
+{
+    //! The peripheral cannot feed the LDMA in EM2, deep sleep is disabled while a transfer is active
+    static constexpr bool LowEnergy = false;
+
+    static IRQn_Type RxIRQn(TPeripheral& p) { return p.RxIRQn(); }
+    static IRQn_Type TxIRQn(TPeripheral& p) { return p.TxIRQn(); }
+
+    //! Enables the receiver interrupt for waking up the waiting task
+    static void RxIRQEnable(TPeripheral& p) { Cortex_SetIRQWakeup(p.RxIRQn()); NVIC_EnableIRQ(p.RxIRQn()); }
+    //! Disables the receiver interrupt
+    static void RxIRQDisable(TPeripheral& p) { NVIC_DisableIRQ(p.RxIRQn()); }
+    //! Enables the transmitter interrupt for waking up the waiting task
+    static void TxIRQEnable(TPeripheral& p) { Cortex_SetIRQWakeup(p.TxIRQn()); NVIC_EnableIRQ(p.TxIRQn()); }
+    //! Disables the transmitter interrupt
+    static void TxIRQDisable(TPeripheral& p) { NVIC_DisableIRQ(p.TxIRQn()); }
+    //! Interrupt flag signaling that the last frame has been shifted out
+    static constexpr uint32_t TxCompleteFlag = USART_IF_TXC;
+
+    //! Called when the receiver starts or stops using the LDMA
+    static void RxActive(TPeripheral& p, bool active) { if (active) { PLATFORM_DEEP_SLEEP_DISABLE(); } else { PLATFORM_DEEP_SLEEP_ENABLE(); } }
+    //! Called when the transmitter starts or stops using the LDMA
+    static void TxActive(TPeripheral& p, bool active) { if (active) { PLATFORM_DEEP_SLEEP_DISABLE(); } else { PLATFORM_DEEP_SLEEP_ENABLE(); } }
+
+    //! Enables or disables the interrupt signaling every received frame
+    static void DataWakeup(TPeripheral& p, bool enable) { enable ? EFM32_BITSET_REG(p.IEN, USART_IEN_RXDATAV) : EFM32_BITCLR_REG(p.IEN, USART_IEN_RXDATAV); }
+
+    //! Configures the interrupt signaling an idle line
+    static void IdleSetup(TPeripheral& p, unsigned bits)
+    {
+#ifdef USART_TIMECMP1_TSTART_RXEOF
+        p.TIMECMP1 = USART_TIMECMP1_TSTART_RXEOF | USART_TIMECMP1_TSTOP_RXACT | (bits << _USART_TIMECMP1_TCMPVAL_SHIFT);
+        EFM32_IFC(&p) = USART_IF_TCMP1;
+        p.IEN |= USART_IEN_TCMP1;
+#else
+        ASSERT(!bits);
+#endif
+    }
+
+    //! The USART has no signal frame detection
+    static void TerminatorSetup(TPeripheral& p, uint8_t terminator) { ASSERT(false); }
+
+    //! Clears the pending wakeup events
+    static void WakeupRearm(TPeripheral& p)
+    {
+#ifdef USART_TIMECMP1_TSTART_RXEOF
+        EFM32_IFC(&p) = USART_IF_TCMP1;
+#endif
+    }
+
+    //! Disables all wakeup interrupts
+    static void WakeupCleanup(TPeripheral& p)
+    {
+#ifdef USART_TIMECMP1_TSTART_RXEOF
+        p.IEN &= ~(USART_IEN_RXDATAV | USART_IEN_TCMP1);
+        p.TIMECMP1 = 0;
+#else
+        p.IEN &= ~USART_IEN_RXDATAV;
+#endif
+    }
+};
+
+template<> struct SerialPipeTraits<USART> : USARTPipeTraitsBase<USART>
+{
+    static constexpr const char* Name = "USART";
+
+    static LDMAChannelHandle RxChannel(USART& p) { return LDMA->GetUSARTChannel(p.Index(), LDMAChannel::USARTSignal::RxDataValid, false); }
+    static LDMAChannelHandle TxChannel(USART& p) { return LDMA->GetUSARTChannel(p.Index(), LDMAChannel::USARTSignal::TxFree, false); }
+};
+
+#if UART_COUNT
+template<> struct SerialPipeTraits<UART> : USARTPipeTraitsBase<UART>
+{
+    static constexpr const char* Name = "UART";
+
+    static LDMAChannelHandle RxChannel(UART& p) { return LDMA->GetUARTChannel(p.Index(), LDMAChannel::UARTSignal::RxDataValid, false); }
+    static LDMAChannelHandle TxChannel(UART& p) { return LDMA->GetUARTChannel(p.Index(), LDMAChannel::UARTSignal::TxFree, false); }
+};
+#endif
+
+#if LEUART_COUNT
+template<> struct SerialPipeTraits<LEUART>
+{
+    static constexpr const char* Name = "LEUART";
+    //! The LEUART wakes up the LDMA by itself, the core can stay in EM2 while data is moving
+    static constexpr bool LowEnergy = true;
+
+    static LDMAChannelHandle RxChannel(LEUART& p) { return LDMA->GetLEUARTChannel(p.Index(), LDMAChannel::LEUARTSignal::RxDataValid, false); }
+    static LDMAChannelHandle TxChannel(LEUART& p) { return LDMA->GetLEUARTChannel(p.Index(), LDMAChannel::LEUARTSignal::TxFree, false); }
+    static IRQn_Type RxIRQn(LEUART& p) { return p.IRQn(); }
+    static IRQn_Type TxIRQn(LEUART& p) { return p.IRQn(); }
+
+    //! The receiver and transmitter share a single interrupt, it is enabled as long as either of them needs it
+    static void RxIRQEnable(LEUART& p) { IRQAcquire(p); }
+    static void RxIRQDisable(LEUART& p) { IRQRelease(p); }
+    static void TxIRQEnable(LEUART& p) { IRQAcquire(p); }
+    static void TxIRQDisable(LEUART& p) { IRQRelease(p); }
+    static constexpr uint32_t TxCompleteFlag = LEUART_IF_TXC;
+
+    static void RxActive(LEUART& p, bool active) { active ? p.Set(LEUART::RxDMAWakeup) : p.Clear(LEUART::RxDMAWakeup); }
+    static void TxActive(LEUART& p, bool active) { active ? p.Set(LEUART::TxDMAWakeup) : p.Clear(LEUART::TxDMAWakeup); }
+
+    static void DataWakeup(LEUART& p, bool enable) { enable ? EFM32_BITSET_REG(p.IEN, LEUART_IEN_RXDATAV) : EFM32_BITCLR_REG(p.IEN, LEUART_IEN_RXDATAV); }
+
+    //! The LEUART has no receive timeout
+    static void IdleSetup(LEUART& p, unsigned bits) { ASSERT(!bits); }
+
+    //! Configures the signal frame interrupt
+    static void TerminatorSetup(LEUART& p, uint8_t terminator)
+    {
+        p.SignalFrame(terminator);
+        EFM32_IFC(&p) = LEUART_IF_SIGF;
+        p.IEN |= LEUART_IEN_SIGF;
+    }
+
+    static void WakeupRearm(LEUART& p) { EFM32_IFC(&p) = LEUART_IF_SIGF; }
+    static void WakeupCleanup(LEUART& p) { p.IEN &= ~(LEUART_IEN_RXDATAV | LEUART_IEN_SIGF); }
+
+private:
+    //! Number of directions using the shared interrupt of each LEUART
+    static uint8_t& IRQUsers(LEUART& p) { static uint8_t users[LEUART_COUNT]; return users[p.Index()]; }
+
+    static void IRQAcquire(LEUART& p)
+    {
+        if (!IRQUsers(p)++)
+        {
+            Cortex_SetIRQWakeup(p.IRQn());
+            NVIC_EnableIRQ(p.IRQn());
+        }
+    }
+
+    static void IRQRelease(LEUART& p)
+    {
+        ASSERT(IRQUsers(p));
+        if (!--IRQUsers(p))
+        {
+            NVIC_DisableIRQ(p.IRQn());
+        }
+    }
+};
+#endif
+
+}
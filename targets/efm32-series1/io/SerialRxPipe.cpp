@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/io/SerialRxPipe.cpp
+ */
+
+#include "SerialRxPipe.h"
+
+#define TRACE_DMA       1
+#define TRACE_PIPE      2
+#define TRACE_DATA      4
+
+//#define USART_RXPIPE_TRACE   TRACE_DATA
+
+#define MYDBG(fmt, ...)      DBGL("%s%d_RX: " fmt, Traits::Name, port.Index(), ## __VA_ARGS__)
+
+#if USART_RXPIPE_TRACE
+#define MYTRACE(flag, ...) if ((USART_RXPIPE_TRACE) & (flag)) { MYDBG(__VA_ARGS__); }
+#else
+#define MYTRACE(...)
+#endif
+
+namespace io
+{
+
+template<class TPeripheral> async(SerialRxPipe<TPeripheral>::Start)
+async_def()
+{
+    if (!dma.IsValid())
+    {
+        dma = Traits::RxChannel(port);
+        if (ringBuffer.Length())
+        {
+            MYDBG("Starting ring %p+%d", ringBuffer.Pointer(), ringBuffer.Length());
+            Traits::RxActive(port, true);
+            ring.Start(dma, &port.RXDATA, ringBuffer, LDMADescriptor::UnitByte);
+            port.RxEnable();
+            dmaMonitor = true;
+            kernel::Task::Run(this, &SerialRxPipe::RingMonitor);
+        }
+        else
+        {
+            kernel::Task::Run(this, &SerialRxPipe::DMATask);
+        }
+    }
+    await_signal(dmaMonitor);
+}
+async_end
+
+template<class TPeripheral> async(SerialRxPipe<TPeripheral>::Stop, Timeout timeout)
+async_def(
+    Timeout timeout;
+)
+{
+    pipe.Close();
+    if (!dma.IsValid())
+    {
+        async_return(true);
+    }
+
+    MYDBG("Stopping");
+    dma.Disable();
+    dma.SetDone();
+    if (ringBuffer.Length())
+    {
+        // there is no DMATask in ring mode, wake up the monitor directly
+        dma.RootDescriptor().Destination(NULL);
+    }
+    if (!await_mask_timeout(dma, ~0u, ~0u, timeout))
+    {
+        MYDBG("Failed to stop");
+        async_return(false);
+    }
+    else
+    {
+        async_return(true);
+    }
+}
+async_end
+
+template<class TPeripheral> async(SerialRxPipe<TPeripheral>::DMATask)
+async_def()
+{
+    MYDBG("Starting");
+
+    dmapos = pipe.Position();
+    Traits::RxActive(port, true);
+
+    chain.Reset(dma);
+
+    while (pipe.AvailableAfter(dmapos) || await(pipe.Allocate, blockSize))
+    {
+        auto desc = LDMADescriptorArena::Alloc(quota);
+        if (!desc)
+        {
+            // quota or arena exhausted, there are already enough segments queued
+            // so just wait for the monitor (or someone else) to release a descriptor
+            auto& mon = LDMADescriptorArena::WatchReleases();
+            await_mask_not(mon, ~0u, mon);
+            continue;
+        }
+
+        auto buf = pipe.GetBufferAt(dmapos).Left(threshold ? std::min(threshold, size_t(LDMADescriptor::MaximumTransferSize)) : LDMADescriptor::MaximumTransferSize);
+        MYTRACE(TRACE_DMA, "LNK+%p %p+%d", desc, buf.Pointer(), buf.Length());
+        desc->SetTransfer(&port.RXDATA, buf.Pointer(), buf.Length(), LDMADescriptor::P2M | LDMADescriptor::UnitByte);
+        if (threshold)
+        {
+            desc->DoneInterrupt();
+        }
+        dmapos += buf.Length();
+        chain.Append(desc);
+        port.RxEnable();
+        StartDMAMonitor();
+    }
+
+    // release channel
+    port.RxDisable();
+    dma.Release();
+    dma.RootDescriptor().Destination(NULL); // this wakes up the rx task
+    FreeUnusedDescriptors();
+    await_signal_off(dmaMonitor);
+    Traits::RxActive(port, false);
+    dma = LDMAChannelHandle();
+    MYDBG("Finished");
+}
+async_end
+
+template<class TPeripheral> void SerialRxPipe<TPeripheral>::StartDMAMonitor()
+{
+    if (!dmaMonitor)
+    {
+        dmaMonitor = true;
+        kernel::Task::Run(this, &SerialRxPipe::DMAMonitor);
+    }
+}
+
+template<class TPeripheral> void SerialRxPipe<TPeripheral>::FreeUnusedDescriptors()
+{
+    while (auto p = chain.Retire())
+    {
+        MYTRACE(TRACE_DMA, "LNK-%p %p+%d", p, p->Destination(), p->Count());
+        LDMADescriptorArena::Free(p, quota);
+    }
+}
+
+template<class TPeripheral> async(SerialRxPipe<TPeripheral>::DMAMonitor)
+async_def()
+{
+    MYDBG("Monitor starting");
+    WakeupSetup();
+
+    while (!pipe.IsClosed())
+    {
+        // we can free all descriptors the channel is done with
+        FreeUnusedDescriptors();
+        auto pMax = (char*)dma.RootDescriptor().DST;
+        NVIC_ClearPendingIRQ(Traits::RxIRQn(port));
+        if (!pMax)
+        {
+            // DST gets zeroed explicitly when stopping
+            break;
+        }
+        size_t count;
+        Buffer buf;
+        while (pipe.Available() && (buf = pipe.GetBuffer(), (count = pMax - buf.Pointer())))
+        {
+            // if the DMA is already writing to another buffer, count will be bigger than buffer size regardless of
+            // where the other buffer is located due to overflow
+            auto newData = buf.Left(count);
+            MYTRACE(TRACE_PIPE, "%p+%d=%p", newData.Pointer(), newData.Length(), newData.end());
+            MYTRACE(TRACE_DATA, "[%p] << %H", newData.Pointer(), newData);
+            pipe.Advance(newData.Length());
+            if (count <= buf.Length())
+            {
+                break;
+            }
+        }
+        await(WaitForData, (uint32_t)pMax);
+    }
+
+    MYDBG("Monitor finished");
+    WakeupCleanup();
+    dmaMonitor = false;
+}
+async_end
+
+template<class TPeripheral> async(SerialRxPipe<TPeripheral>::RingMonitor)
+async_def(
+    uint32_t dst;
+)
+{
+    MYDBG("Ring monitor starting");
+    WakeupSetup();
+
+    while (!pipe.IsClosed())
+    {
+        f.dst = dma.RootDescriptor().DST;
+        NVIC_ClearPendingIRQ(Traits::RxIRQn(port));
+        if (!f.dst)
+        {
+            // DST gets zeroed explicitly when stopping
+            break;
+        }
+
+        while (ring.Available().Length())
+        {
+            if (!pipe.Available() && !await(pipe.Allocate, blockSize))
+            {
+                break;
+            }
+
+            if (ring.Overrun())
+            {
+                overruns++;
+                MYDBG("Ring overrun, data lost");
+                continue;
+            }
+
+            auto data = ring.Available();
+            auto buf = pipe.GetBuffer();
+            size_t count = std::min(data.Length(), buf.Length());
+            memcpy(buf.Pointer(), data.Pointer(), count);
+            MYTRACE(TRACE_PIPE, "%p+%d=%p", buf.Pointer(), count, buf.Pointer() + count);
+            MYTRACE(TRACE_DATA, "[%p] << %H", buf.Pointer(), buf.Left(count));
+            pipe.Advance(count);
+            ring.Consume(count);
+        }
+
+        await(WaitForData, f.dst);
+    }
+
+    MYDBG("Ring monitor finished");
+    WakeupCleanup();
+    port.RxDisable();
+    ring.Stop();
+    dma.Release();
+    Traits::RxActive(port, false);
+    dmaMonitor = false;
+    dma = LDMAChannelHandle();
+}
+async_end
+
+/*!
+ * Configures the interrupts that wake up the monitor task
+ *
+ * Without batching, the monitor wakes up on every RXDATAV request.
+ * Otherwise, the peripheral signals an idle line (USART receive timeout,
+ * TIMECMP1 started by the end of a frame and stopped by RX activity)
+ * or a terminator byte (LEUART signal frame) and the DONE flag of
+ * the LDMA channel signals a full threshold block or half of the ring
+ */
+template<class TPeripheral> void SerialRxPipe<TPeripheral>::WakeupSetup()
+{
+    lastDst = 0;
+
+    if (!Batched())
+    {
+        Traits::DataWakeup(port, true);
+    }
+    else
+    {
+        if (idleBits)
+        {
+            Traits::IdleSetup(port, idleBits);
+        }
+
+        if (terminator >= 0)
+        {
+            Traits::TerminatorSetup(port, terminator);
+        }
+
+        if (DoneWakeup())
+        {
+            dma.ClearDone();
+            dma.EnableDoneInterrupt();
+        }
+    }
+
+    Traits::RxIRQEnable(port);
+}
+
+template<class TPeripheral> void SerialRxPipe<TPeripheral>::WakeupCleanup()
+{
+    Traits::RxIRQDisable(port);
+    Traits::WakeupCleanup(port);
+    if (DoneWakeup())
+    {
+        dma.DisableDoneInterrupt();
+    }
+}
+
+/*!
+ * Waits until the DST of the channel moves past the specified value
+ *
+ * With batching enabled, the DMA requests themselves do not wake up
+ * the monitor, the wait ends only after one of the configured batching
+ * conditions occurs. The max latency deadline is armed only while data
+ * keeps flowing, an idle line is detected by the first received byte.
+ */
+template<class TPeripheral> async(SerialRxPipe<TPeripheral>::WaitForData, uint32_t dst)
+async_def()
+{
+    if (!Batched())
+    {
+        await_mask_not(dma.RootDescriptor().DST, ~0u, dst);
+        async_return(true);
+    }
+
+    Traits::WakeupRearm(port);
+    if (DoneWakeup())
+    {
+        dma.ClearDone();
+    }
+
+    if (maxLatency)
+    {
+        bool flowing = dst != lastDst;
+        lastDst = dst;
+        if (flowing)
+        {
+            Traits::DataWakeup(port, false);
+            NVIC_ClearPendingIRQ(Traits::RxIRQn(port));
+            await_mask_not_ms(dma.RootDescriptor().DST, ~0u, dst, maxLatency);
+            async_return(true);
+        }
+
+        // make sure the first byte is noticed
+        Traits::DataWakeup(port, true);
+    }
+
+    NVIC_ClearPendingIRQ(Traits::RxIRQn(port));
+    await_mask_not(dma.RootDescriptor().DST, ~0u, dst);
+    async_return(true);
+}
+async_end
+
+template class SerialRxPipe<USART>;
+#if UART_COUNT
+template class SerialRxPipe<UART>;
+#endif
+#if LEUART_COUNT
+template class SerialRxPipe<LEUART>;
+#endif
+
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/io/SerialRxPipe.h
+ */
+
+#pragma once
+
+#include <io/io.h>
+
+#include <io/SerialPipeTraits.h>
+
+#ifndef USART_RXPIPE_DESCRIPTORS
+//! Maximum number of LDMA descriptors a single SerialRxPipe can have linked at once
+#define USART_RXPIPE_DESCRIPTORS    4
+#endif
+
+namespace io
+{
+
+/*!
+ * Receives data from a serial peripheral into a pipe using the LDMA
+ *
+ * The implementation is shared by all the peripherals described by
+ * @ref SerialPipeTraits, use the @ref USARTRxPipe, @ref UARTRxPipe
+ * and @ref LEUARTRxPipe aliases
+ */
+template<class TPeripheral> class SerialRxPipe
+{
+    using Traits = SerialPipeTraits<TPeripheral>;
+
+public:
+    SerialRxPipe(TPeripheral& port, PipeWriter pipe, size_t blockSize = 256)
+        : port(port), pipe(pipe), blockSize(blockSize)
+    {
+    }
+
+    //! Creates a pipe that captures data continuously into the specified ring buffer
+    //! and copies it to the pipe, without ever stopping the DMA channel
+    //! @note The ring must be large enough to cover the latency of the monitor task
+    //! at the used baud rate, otherwise data will be lost
+    //! @note On low energy peripherals, the monitor task is always woken up when
+    //! half of the ring is filled, so the core can stay in EM2 in the meantime
+    SerialRxPipe(TPeripheral& port, PipeWriter pipe, Buffer ring, size_t blockSize = 256)
+        : port(port), pipe(pipe), blockSize(blockSize), ringBuffer(ring)
+    {
+    }
+
+    TPeripheral& GetPeripheral() const { return port; }
+    //! @deprecated Use @ref GetPeripheral
+    TPeripheral& GetUSART() const { return port; }
+
+    //! Configures batching of received data before it is published to the pipe, must be called before @ref Start
+    //! @param idleBits Publishes data after the line has been idle for the specified number of bit periods (1-255),
+    //! not supported on the LEUART
+    //! @param threshold Publishes data every time the specified number of bytes is received,
+    //! in ring mode the threshold is always one half of the ring
+    //! @param maxLatencyMs Publishes data at least this often while data keeps arriving
+    //! @note Without any batching, the monitor task wakes up for every received byte
+    void Batching(unsigned idleBits, size_t threshold = 0, unsigned maxLatencyMs = 0)
+    {
+        ASSERT(idleBits < 256);
+        this->idleBits = idleBits;
+        this->threshold = threshold;
+        this->maxLatency = maxLatencyMs;
+    }
+
+    //! Publishes data as soon as the specified byte is received (e.g. '\n'), must be called before @ref Start
+    //! @note Supported only on the LEUART, which detects the byte in hardware
+    void Terminator(uint8_t terminator)
+    {
+        this->terminator = terminator;
+    }
+
+    async(Start);
+    async(Stop, Timeout timeout = Timeout::Infinite);
+
+    //! Gets the number of times data was lost because the consumer did not keep up with the ring
+    size_t Overruns() const { return overruns; }
+
+private:
+    TPeripheral& port;
+    PipeWriter pipe;
+    size_t blockSize;
+    LDMAChannelHandle dma;
+    LDMAChain chain;
+    LDMADescriptorArena::Quota quota = USART_RXPIPE_DESCRIPTORS;
+    PipePosition dmapos;
+    bool dmaMonitor = false;
+    Buffer ringBuffer;
+    LDMARing ring;
+    uint8_t idleBits = 0;
+    int16_t terminator = -1;
+    uint16_t maxLatency = 0;
+    size_t threshold = 0;
+    size_t overruns = 0;
+    uint32_t lastDst;
+
+    async(DMATask);
+    async(DMAMonitor);
+    async(RingMonitor);
+    async(WaitForData, uint32_t dst);
+
+    //! Checks if the DONE flag of the channel wakes up the monitor
+    bool DoneWakeup() const { return threshold || (Traits::LowEnergy && ringBuffer.Length()); }
+    bool Batched() const { return idleBits || terminator >= 0 || maxLatency || DoneWakeup(); }
+    void WakeupSetup();
+    void WakeupCleanup();
+    void StartDMAMonitor();
+    void FreeUnusedDescriptors();
+};
+
+using USARTRxPipe = SerialRxPipe<USART>;
+#if UART_COUNT
+using UARTRxPipe = SerialRxPipe<UART>;
+#endif
+#if LEUART_COUNT
+using LEUARTRxPipe = SerialRxPipe<LEUART>;
+#endif
+
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/io/SerialService.cpp
+ */
+
+#include "SerialService.h"
+
+//#define SERIAL_SERVICE_TRACE    1
+
+#define MYDBG(fmt, ...)    DBGL("SERIAL: " fmt, ## __VA_ARGS__)
+
+#if SERIAL_SERVICE_TRACE
+#define MYTRACE MYDBG
+#else
+#define MYTRACE(...)
+#endif
+
+namespace io
+{
+
+void SerialService::Add(Port& port)
+{
+    ASSERT(!port.service);
+    port.stopping = false;
+    port.Start();
+    port.dma.EnableDoneInterrupt();
+    port.service = this;
+    port.next = ports;
+    ports = &port;
+
+    if (!running)
+    {
+        running = true;
+        kernel::Task::Run(this, &SerialService::Task);
+    }
+    else
+    {
+        // make sure the service starts watching the new channel
+        port.Kick();
+    }
+}
+
+/*!
+ * Single task servicing all the attached ports
+ *
+ * The task waits for the DONE signal of any of the channels, so
+ * the LDMA interrupt (or a kick) is the only wakeup source besides
+ * the interval, which applies only while some port is active.
+ */
+async(SerialService::Task)
+async_def(
+    uint32_t mask;
+    bool active;
+)
+{
+    MYDBG("Starting");
+
+    f.active = false;
+    while (ports)
+    {
+        f.mask = 0;
+        for (auto p = ports; p; p = p->next)
+        {
+            f.mask |= BIT(p->dma);
+        }
+
+        if (f.active)
+        {
+            await_mask_not_ms(LDMAController::DoneSignals(), f.mask, 0, interval);
+        }
+        else
+        {
+            await_mask_not(LDMAController::DoneSignals(), f.mask, 0);
+        }
+        MYTRACE("%X", LDMAController::DoneSignals() & f.mask);
+
+        f.active = false;
+
+        for (Port** pp = &ports; *pp;)
+        {
+            auto p = *pp;
+            p->dma.ClearDone();
+            if (p->Service())
+            {
+                f.active |= p->Active();
+                pp = &p->next;
+            }
+            else
+            {
+                *pp = p->next;
+                p->service = NULL;
+            }
+        }
+    }
+
+    MYDBG("Finished");
+    running = false;
+}
+async_end
+
+template<class TPeripheral> void SerialService::Rx<TPeripheral>::Start()
+{
+    dma = Traits::RxChannel(port);
+    Traits::RxActive(port, true);
+    ring.Start(dma, &port.RXDATA, ringBuffer, LDMADescriptor::UnitByte | LDMADescriptor::SetDone);
+    received = starving = false;
+    Cortex_SetIRQHandler(Traits::RxIRQn(port), GetDelegate(this, &Rx::DataHandler));
+    NVIC_ClearPendingIRQ(Traits::RxIRQn(port));
+    NVIC_EnableIRQ(Traits::RxIRQn(port));
+    port.RxEnable();
+}
+
+template<class TPeripheral> bool SerialService::Rx<TPeripheral>::Service()
+{
+    if (stopping || pipe.IsClosed())
+    {
+        pipe.Close();
+        port.RxDisable();
+        Traits::DataWakeup(port, false);
+        NVIC_DisableIRQ(Traits::RxIRQn(port));
+        dma.DisableDoneInterrupt();
+        ring.Stop();
+        dma.Release();
+        Traits::RxActive(port, false);
+        dma = LDMAChannelHandle();
+        return false;
+    }
+
+    if (ring.Overrun())
+    {
+        overruns++;
+        MYDBG("Ring overrun, data lost");
+    }
+
+    Span data;
+    received = false;
+    while ((data = ring.Available()).Length() && pipe.Available())
+    {
+        auto buf = pipe.GetBuffer();
+        size_t count = std::min(data.Length(), buf.Length());
+        memcpy(buf.Pointer(), data.Pointer(), count);
+        pipe.Advance(count);
+        ring.Consume(count);
+        received = true;
+    }
+
+    // a full pipe is just checked again after the interval, not to block the other ports
+    starving = ring.Available().Length();
+    if (!received && !starving)
+    {
+        // the line is quiet, the interrupt kicks the service on the next byte
+        Traits::DataWakeup(port, true);
+        if (ring.Available().Length())
+        {
+            // the byte has arrived while enabling the interrupt
+            Traits::DataWakeup(port, false);
+            received = true;
+        }
+    }
+    return true;
+}
+
+//! Called from the peripheral interrupt when data arrives on a quiet line
+template<class TPeripheral> void SerialService::Rx<TPeripheral>::DataHandler()
+{
+    Traits::DataWakeup(port, false);
+    Kick();
+}
+
+template<class TPeripheral> void SerialService::Tx<TPeripheral>::Start()
+{
+    dma = Traits::TxChannel(port);
+    sending = 0;
+}
+
+template<class TPeripheral> bool SerialService::Tx<TPeripheral>::Service()
+{
+    if (sending)
+    {
+        if (dma.IsEnabled())
+        {
+            // still transmitting, the DONE flag was set by a kick
+            return true;
+        }
+
+        pipe.Advance(sending);
+        sending = 0;
+        Traits::TxActive(port, false);
+    }
+
+    if (pipe.Available())
+    {
+        auto span = pipe.GetSpan().Left(LDMADescriptor::MaximumTransferSize);
+        desc.SetTransfer(span.Pointer(), &port.TXDATA, span.Length(), LDMADescriptor::M2P | LDMADescriptor::UnitByte | LDMADescriptor::SetDone);
+        sending = span.Length();
+        Traits::TxActive(port, true);
+        dma.LinkLoad(desc);
+        port.TxEnable();
+        return true;
+    }
+
+    if (stopping && port.TxComplete())
+    {
+        port.TxDisable();
+        dma.DisableDoneInterrupt();
+        dma.Release();
+        dma = LDMAChannelHandle();
+        return false;
+    }
+
+    return true;
+}
+
+template class SerialService::Rx<USART>;
+template class SerialService::Tx<USART>;
+#if UART_COUNT
+template class SerialService::Rx<UART>;
+template class SerialService::Tx<UART>;
+#endif
+#if LEUART_COUNT
+template class SerialService::Rx<LEUART>;
+template class SerialService::Tx<LEUART>;
+#endif
+
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/io/SerialService.h
+ */
+
+#pragma once
+
+#include <io/io.h>
+
+#include <io/SerialPipeTraits.h>
+
+#ifndef SERIAL_SERVICE_INTERVAL
+//! Default period in milliseconds in which the SerialService checks its active ports,
+//! bounds the latency of partially filled receive rings and of data written for transmission
+#define SERIAL_SERVICE_INTERVAL     10
+#endif
+
+namespace io
+{
+
+/*!
+ * Services many serial pipes from a single task
+ *
+ * The standalone @ref SerialRxPipe and @ref SerialTxPipe run one or two
+ * tasks per direction, which adds up when there are many links. The ports
+ * of the service are just the state needed to drive the LDMA, a single
+ * task wakes up on the DONE flag of any of their channels (half of
+ * a receive ring filled, transmit segment finished) and moves the data
+ * between the rings and the pipes of all ports at once.
+ *
+ * There are no per-port tasks. A quiet receiver kicks the service from
+ * the peripheral interrupt when its first byte arrives, so the service does
+ * not wake up at all while all receivers are quiet. Receivers with data
+ * flowing or with a full pipe are checked every service interval.
+ * Transmitters cannot be notified of data written to their pipes, so they
+ * are checked every service interval, writers can call @ref Port::Kick
+ * to have new data sent right away.
+ *
+ * Receivers always run in ring mode and own the peripheral interrupt.
+ */
+class SerialService
+{
+public:
+    SerialService(unsigned intervalMs = SERIAL_SERVICE_INTERVAL)
+        : interval(intervalMs) {}
+
+    class Port
+    {
+    public:
+        //! Checks if the port is attached to a service
+        bool IsRunning() const { return service; }
+        //! Wakes up the service to check the port right away
+        void Kick() { if (dma.IsValid()) { dma.SetDone(); } }
+        //! Stops the port, it is detached from the service on the next wakeup
+        void Stop() { stopping = true; Kick(); }
+
+    protected:
+        LDMAChannelHandle dma;
+        bool stopping = false;
+
+        //! Configures the hardware and allocates the LDMA channel
+        virtual void Start() = 0;
+        //! Moves data between the hardware and the pipe, returns false after
+        //! the port has released all its resources and can be detached
+        virtual bool Service() = 0;
+        //! Checks if the port has seen activity that warrants checking it again after the service interval
+        virtual bool Active() { return false; }
+
+    private:
+        Port* next;
+        SerialService* service = NULL;
+
+        friend class SerialService;
+    };
+
+    template<class TPeripheral> class Rx;
+    template<class TPeripheral> class Tx;
+
+    //! Attaches the port to the service and starts it
+    void Add(Port& port);
+
+private:
+    Port* ports = NULL;
+    uint16_t interval;
+    bool running = false;
+
+    async(Task);
+};
+
+//! Receiving port of a @ref SerialService
+template<class TPeripheral> class SerialService::Rx : public SerialService::Port
+{
+    using Traits = SerialPipeTraits<TPeripheral>;
+
+public:
+    //! @note The ring must be large enough to cover the data received during
+    //! the service interval, otherwise data will be lost
+    Rx(TPeripheral& port, PipeWriter pipe, Buffer ring, size_t blockSize = 256)
+        : port(port), pipe(pipe), ringBuffer(ring), blockSize(blockSize) {}
+
+    TPeripheral& GetPeripheral() const { return port; }
+    //! Gets the number of times data was lost because the consumer did not keep up with the ring
+    size_t Overruns() const { return overruns; }
+
+protected:
+    void Start() override;
+    bool Service() override;
+    //! A receiver with data flowing or a full pipe is checked periodically
+    bool Active() override { return received || starving; }
+
+private:
+    TPeripheral& port;
+    PipeWriter pipe;
+    Buffer ringBuffer;
+    LDMARing ring;
+    size_t blockSize;
+    size_t overruns = 0;
+    bool received = false;
+    bool starving = false;
+
+    void DataHandler();
+};
+
+//! Transmitting port of a @ref SerialService
+template<class TPeripheral> class SerialService::Tx : public SerialService::Port
+{
+    using Traits = SerialPipeTraits<TPeripheral>;
+
+public:
+    Tx(TPeripheral& port, PipeReader pipe)
+        : port(port), pipe(pipe) {}
+
+    TPeripheral& GetPeripheral() const { return port; }
+
+protected:
+    void Start() override;
+    bool Service() override;
+    //! There is no signal for new data in the pipe, the transmitter is always checked periodically
+    bool Active() override { return true; }
+
+private:
+    TPeripheral& port;
+    PipeReader pipe;
+    LDMADescriptor desc;
+    size_t sending = 0;
+};
+
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/io/SerialTxPipe.cpp
+ */
+
+#include "SerialTxPipe.h"
+
+//#define USART_TXPIPE_TRACE    1
+
+#define MYDBG(fmt, ...)    DBGL("%s%d_TX: " fmt, Traits::Name, port.Index(), ## __VA_ARGS__)
+
+#if USART_TXPIPE_TRACE
+#define MYTRACE MYDBG
+#else
+#define MYTRACE(...)
+#endif
+
+namespace io
+{
+
+template<class TPeripheral> async(SerialTxPipe<TPeripheral>::Start)
+async_def_sync()
+{
+    if (!running)
+    {
+        running = true;
+        if (quota.limit > 1)
+        {
+            kernel::Task::Run(this, &SerialTxPipe::ChainTask);
+        }
+        else
+        {
+            kernel::Task::Run(this, &SerialTxPipe::Task);
+        }
+    }
+    async_return(true);
+}
+async_end
+
+template<class TPeripheral> async(SerialTxPipe<TPeripheral>::Stop, Timeout timeout)
+async_def_once()
+{
+    async_return(await_signal_off_timeout(running, timeout));
+}
+async_end
+
+template<class TPeripheral> async(SerialTxPipe<TPeripheral>::Task)
+async_def(
+    LDMAChannelHandle dma;
+    LDMADescriptor desc;
+)
+{
+    f.dma = Traits::TxChannel(port);
+    MYDBG("Starting");
+
+    while (await(pipe.Require))
+    {
+        auto span = pipe.GetSpan().Left(LDMADescriptor::MaximumTransferSize);
+        MYTRACE(">> %H", span);
+        f.desc.SetTransfer(span.Pointer(), &port.TXDATA, span.Length(), LDMADescriptor::M2P | LDMADescriptor::UnitByte | LDMADescriptor::SetDone);
+        f.dma.LinkLoad(f.desc);
+        port.TxEnable();
+        Traits::TxActive(port, true);
+        await(f.dma.WaitForDoneFlag);
+        Traits::TxActive(port, false);
+        MYTRACE(">> DONE");
+        pipe.Advance(f.desc.Count());
+    }
+
+    MYDBG("Finished");
+    await(WaitTxComplete);
+    port.TxDisable();
+    f.dma.Release();
+    running = false;
+}
+async_end
+
+/*!
+ * Keeps linking available pipe segments to the running LDMA chain
+ *
+ * New data is linked as soon as it is written to the pipe, even while
+ * the previous batch is still being transmitted, so there is no gap
+ * between batches. The segments already sent are retired by @ref RetireTask.
+ */
+template<class TPeripheral> async(SerialTxPipe<TPeripheral>::ChainTask)
+async_def(
+    uint32_t releases;
+)
+{
+    chain.Reset(Traits::TxChannel(port));
+    queued = 0;
+    linking = true;
+    MYDBG("Starting chained");
+    kernel::Task::Run(this, &SerialTxPipe::RetireTask);
+
+    // wait for data beyond what is already linked
+    while (await(pipe.Require, queued + 1))
+    {
+        f.releases = LDMADescriptorArena::WatchReleases();
+        if (!Link())
+        {
+            // out of descriptors, wait until some are retired
+            await_mask_not(LDMADescriptorArena::WatchReleases(), ~0u, f.releases);
+        }
+    }
+
+    MYDBG("Finished");
+    linking = false;
+    // wake up the retire task so it notices the end
+    chain.Channel().SetDone();
+    await_signal_off(retiring);
+    await(WaitTxComplete);
+    port.TxDisable();
+    chain.Channel().Release();
+    running = false;
+}
+async_end
+
+/*!
+ * Links all pipe data that is not linked yet as a new batch
+ *
+ * Only the last descriptor of each batch sets the DONE flag
+ *
+ * @returns false if the descriptor quota has been exhausted before all data was linked
+ */
+template<class TPeripheral> bool SerialTxPipe<TPeripheral>::Link()
+{
+    LDMADescriptor* first = NULL;
+    LDMADescriptor* last = NULL;
+    bool complete = true;
+
+    while (queued < pipe.Available())
+    {
+        auto desc = LDMADescriptorArena::Alloc(quota);
+        if (!desc)
+        {
+            complete = false;
+            break;
+        }
+        auto span = pipe.GetSpan(queued).Left(LDMADescriptor::MaximumTransferSize);
+        MYTRACE(">> %H", span);
+        desc->SetTransfer(span.Pointer(), &port.TXDATA, span.Length(), LDMADescriptor::M2P | LDMADescriptor::UnitByte);
+        queued += span.Length();
+        if (last)
+        {
+            last->Link(desc);
+        }
+        else
+        {
+            first = desc;
+        }
+        last = desc;
+    }
+
+    if (last)
+    {
+        last->DoneInterrupt();
+        if (chain.IsEmpty())
+        {
+            Traits::TxActive(port, true);
+        }
+        port.TxEnable();
+        chain.Append(first, last);
+    }
+
+    return complete;
+}
+
+/*!
+ * Releases the descriptors the channel is done with and advances
+ * the reader past the data they have sent
+ */
+template<class TPeripheral> async(SerialTxPipe<TPeripheral>::RetireTask)
+async_def()
+{
+    retiring = true;
+
+    while (linking || !chain.IsEmpty())
+    {
+        await(LDMA->WaitForDoneMask, BIT(chain.Channel()));
+
+        while (auto desc = chain.Retire())
+        {
+            size_t count = desc->Count();
+            MYTRACE(">> DONE %d", count);
+            LDMADescriptorArena::Free(desc, quota);
+            pipe.Advance(count);
+            queued -= count;
+            if (chain.IsEmpty())
+            {
+                Traits::TxActive(port, false);
+            }
+        }
+    }
+
+    retiring = false;
+}
+async_end
+
+/*!
+ * Waits until the last frame is shifted out, so disabling
+ * the transmitter does not cut it off
+ */
+template<class TPeripheral> async(SerialTxPipe<TPeripheral>::WaitTxComplete)
+async_def()
+{
+    // the flag may be left over from a previous transmission
+    EFM32_IFC(&port) = Traits::TxCompleteFlag;
+    if (!port.TxComplete())
+    {
+        NVIC_ClearPendingIRQ(Traits::TxIRQn(port));
+        Traits::TxIRQEnable(port);
+        EFM32_BITSET_REG(port.IEN, Traits::TxCompleteFlag);
+
+        await_mask_not(port.IF, Traits::TxCompleteFlag, 0);
+
+        EFM32_BITCLR_REG(port.IEN, Traits::TxCompleteFlag);
+        Traits::TxIRQDisable(port);
+    }
+}
+async_end
+
+template class SerialTxPipe<USART>;
+#if UART_COUNT
+template class SerialTxPipe<UART>;
+#endif
+#if LEUART_COUNT
+template class SerialTxPipe<LEUART>;
+#endif
+
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32-series1/io/SerialTxPipe.h
+ */
+
+#pragma once
+
+#include <io/io.h>
+
+#include <io/SerialPipeTraits.h>
+
+namespace io
+{
+
+/*!
+ * Transmits data from a pipe over a serial peripheral using the LDMA
+ *
+ * The implementation is shared by all the peripherals described by
+ * @ref SerialPipeTraits, use the @ref USARTTxPipe, @ref UARTTxPipe
+ * and @ref LEUARTTxPipe aliases
+ */
+template<class TPeripheral> class SerialTxPipe
+{
+    using Traits = SerialPipeTraits<TPeripheral>;
+
+public:
+    //! Creates a transmit pipe
+    //! @param chain Maximum number of pipe segments linked to the running LDMA chain at once,
+    //! values greater than one keep the line busy while further data is being linked
+    SerialTxPipe(TPeripheral& port, PipeReader pipe, size_t chain = 1)
+        : port(port), pipe(pipe), quota(chain)
+    {
+    }
+
+    TPeripheral& GetPeripheral() const { return port; }
+    //! @deprecated Use @ref GetPeripheral
+    TPeripheral& GetUSART() const { return port; }
+
+    async(Start);
+    async(Stop, Timeout timeout = Timeout::Infinite);
+
+private:
+    TPeripheral& port;
+    PipeReader pipe;
+    bool running = false;
+
+    LDMADescriptorArena::Quota quota;
+    LDMAChain chain;
+    size_t queued;
+    bool linking = false;
+    bool retiring = false;
+
+    async(Task);
+    async(ChainTask);
+    async(RetireTask);
+    async(WaitTxComplete);
+    bool Link();
+};
+
+using USARTTxPipe = SerialTxPipe<USART>;
+#if UART_COUNT
+using UARTTxPipe = SerialTxPipe<UART>;
+#endif
+#if LEUART_COUNT
+using LEUARTTxPipe = SerialTxPipe<LEUART>;
+#endif
+
+}
@@ -8,41 +8,6 @@
 
 #pragma once
 
-#include <io/io.h>
-
-#include <hw/LDMA.h>
-#include <hw/USART.h>
-
-namespace io
-{
-
-class USARTRxPipe
-{
-public:
-    USARTRxPipe(USART& usart, PipeWriter pipe, size_t blockSize = 256)
-        : usart(usart), pipe(pipe), blockSize(blockSize)
-    {
-    }
-
-    USART& GetUSART() const { return usart; }
-
-    async(Start);
-    async(Stop, Timeout timeout = Timeout::Infinite);
-
-private:
-    USART& usart;
-    PipeWriter pipe;
-    size_t blockSize;
-    LDMAChannelHandle dma;
-    LDMADescriptor* allocList;
-    PipePosition dmapos;
-    bool dmaMonitor = false;
-
-    async(DMATask);
-    async(DMAMonitor);
-
-    void StartDMAMonitor();
-    void FreeUnusedDescriptors(LDMADescriptor* stop);
-};
-
-}
+//! @file
+//! The pipe is implemented by the shared @ref io::SerialRxPipe template
+#include <io/SerialRxPipe.h>
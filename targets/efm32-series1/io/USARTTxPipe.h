@@ -8,34 +8,6 @@
 
 #pragma once
 
-#include <io/io.h>
-
-#include <hw/USART.h>
-
-namespace io
-{
-
-class USARTTxPipe
-{
-public:
-    USARTTxPipe(USART& usart, PipeReader pipe)
-        : usart(usart), pipe(pipe)
-    {
-    }
-
-    USART& GetUSART() const { return usart; }
-
-    async(Start);
-    async(Stop, Timeout timeout = Timeout::Infinite);
-
-private:
-    USART& usart;
-    PipeReader pipe;
-    bool running = false;
-
-    LDMADescriptor* freeDescriptors;
-
-    async(Task);
-};
-
-}
+//! @file
+//! The pipe is implemented by the shared @ref io::SerialTxPipe template
+#include <io/SerialTxPipe.h>
@@ -17,12 +17,135 @@
 #include <hw/MSC.h>
 #include <hw/GPIO.h>
 
+#if EFM32_LDMA_STARTUP
+
+#include <hw/LDMA.h>
+
+extern uint8_t __data_start[], __data_end[], __data_load[];
+extern uint8_t __bss_start[], __bss_end[];
+
+// the source of the .bss fill must not be in .bss itself
+static const uint32_t s_ldmaZero = 0;
+
+//! Checks if .data and .bss can be initialized by the LDMA, i.e. the stack is not in the way
+static bool _efm32_ldma_init_usable()
+{
+    uint8_t* sp = (uint8_t*)__get_MSP();
+    return !(sp > __data_start && sp <= __data_end) && !(sp > __bss_start && sp <= __bss_end);
+}
+
+/*!
+ * Starts the next chunk of the initialization of a memory region on the specified channel
+ *
+ * There is no memory for descriptors before .data and .bss are initialized,
+ * so the channel registers are programmed directly. They are left pointing
+ * behind the chunk, so the next one continues from there.
+ *
+ * @returns false if there is nothing left to transfer
+ */
+static bool _efm32_ldma_init_chunk(unsigned index, const void* src, uint8_t* dst, uint8_t* end)
+{
+    auto ch = LDMA->GetChannelByIndex(index);
+    auto& root = ch.RootDescriptor();
+    bool fill = src == &s_ldmaZero;
+    size_t length = end - dst;
+    if (!length)
+    {
+        root.SRC = (uint32_t)src;
+        root.DST = (uint32_t)dst;
+        return false;
+    }
+
+    bool word = !(((uintptr_t)dst | length | (fill ? 0 : (uintptr_t)src)) & 3);
+    size_t count = std::min(word ? length / 4 : length, size_t(LDMADescriptor::MaximumTransferSize));
+    auto desc = LDMADescriptor::Transfer(src, dst, count,
+        (word ? LDMADescriptor::UnitWord : LDMADescriptor::UnitByte) |
+        (fill ? LDMADescriptor::P2M : LDMADescriptor::M2M) |
+        LDMADescriptor::TransferModeAll | LDMADescriptor::BlockSizeAll);
+
+    root.SRC = desc.SRC;
+    root.DST = desc.DST;
+    root.LINK = 0;
+    root.CTRL = desc.CTRL;
+    ch.Enable();
+    ch.Request();
+    return true;
+}
+
+//! Continues the initialization of a memory region if the channel has finished the previous chunk
+//! @returns false if the region is complete
+static bool _efm32_ldma_init_continue(unsigned index, uint8_t* end)
+{
+    auto ch = LDMA->GetChannelByIndex(index);
+    if (ch.IsEnabled())
+    {
+        return true;
+    }
+
+    auto& root = ch.RootDescriptor();
+    return _efm32_ldma_init_chunk(index, root.Source(), (uint8_t*)root.Destination(), end);
+}
+
+/*!
+ * Completes the initialization of .data and .bss started in _efm32_startup
+ *
+ * Called by the core startup instead of its own initialization loops,
+ * falls back to the CPU if the LDMA could not be used or reports an error.
+ */
+void _efm32_data_init()
+{
+    bool ok = _efm32_ldma_init_usable();
+    if (ok)
+    {
+        for (;;)
+        {
+            if (LDMA->IF & LDMA_IF_ERROR)
+            {
+                LDMA->GetChannelByIndex(0).Disable();
+                LDMA->GetChannelByIndex(1).Disable();
+                ok = false;
+                break;
+            }
+
+            bool data = _efm32_ldma_init_continue(0, __data_end);
+            bool bss = _efm32_ldma_init_continue(1, __bss_end);
+            if (!data && !bss)
+            {
+                break;
+            }
+        }
+
+        // leave the LDMA in a clean state for regular use
+        EFM32_BITCLR_REG(LDMA->CHDONE, BIT(0) | BIT(1));
+        EFM32_IFC(LDMA) = ~0u;
+    }
+
+    if (!ok)
+    {
+        memcpy(__data_start, __data_load, __data_end - __data_start);
+        memset(__bss_start, 0, __bss_end - __bss_start);
+    }
+}
+
+#endif
+
 void _efm32_startup()
 {
     // apply EMLIB errata fixes
     // this is an inline function, so we actually don't need the full emlib component for it, just the headers
     CHIP_Init();
 
+#if EFM32_LDMA_STARTUP
+    // start initializing .data and .bss, it runs while the rest of the hardware is set up
+    // nothing below may touch .data or .bss, it is completed in _efm32_data_init
+    if (_efm32_ldma_init_usable())
+    {
+        LDMA->EnableClock();
+        _efm32_ldma_init_chunk(0, __data_load, __data_start, __data_end);
+        _efm32_ldma_init_chunk(1, &s_ldmaZero, __bss_start, __bss_end);
+    }
+#endif
+
     CMU->EarlyConfigure();
 
     // enable clock to GPIO
@@ -29,10 +29,23 @@
 #define PLATFORM_WATCHDOG_HIT()
 #endif
 
+#ifndef EFM32_LDMA_STARTUP
+//! Initializes .data and .bss using the LDMA, overlapped with the hardware initialization
+//! @note Requires a core startup that calls CORTEX_STARTUP_DATA_INIT instead of its own initialization loops
+#define EFM32_LDMA_STARTUP      0
+#endif
+
+#if EFM32_LDMA_STARTUP
+#define CORTEX_STARTUP_DATA_INIT    _efm32_data_init
+#endif
+
 #include_next <base/platform.h>
 
 extern void _efm32_startup();
 extern void _efm32_c_startup();
+#if EFM32_LDMA_STARTUP
+extern void _efm32_data_init();
+#endif
 #if EFM32_WATCHDOG_TIMEOUT
 extern void _efm32_hit_watchdog();
 #endif
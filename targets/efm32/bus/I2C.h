@@ -35,6 +35,11 @@ public:
     //! Continues a write transaction, writing the specified number of bytes to the bus
     async(Write, Span data, bool stop) { return async_forward(i2c.Write, data, stop); }
 
+    //! Executes a list of transaction segments under a single lock acquisition
+    async(Transfer, ::I2C::Message* messages, size_t count, ::I2C::Priority priority = ::I2C::Priority::Normal) { return async_forward(i2c.Transfer, messages, count, priority); }
+    //! Executes a list of transaction segments under a single lock acquisition
+    template<size_t n> async(Transfer, ::I2C::Message (&messages)[n], ::I2C::Priority priority = ::I2C::Priority::Normal) { return async_forward(i2c.Transfer, messages, n, priority); }
+
     //! Gets the current bus frequency
     uint32_t OutputFrequency() const { return i2c.OutputFrequency(); }
     //! Sets the current bus frequency
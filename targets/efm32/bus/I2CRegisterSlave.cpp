@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32/bus/I2CRegisterSlave.cpp
+ */
+
+#include "I2CRegisterSlave.h"
+
+//#define I2C_REGISTER_SLAVE_TRACE  1
+
+#define MYDBG(fmt, ...)    DBGL("I2C%d_REG: " fmt, i2c.Index(), ## __VA_ARGS__)
+
+#if I2C_REGISTER_SLAVE_TRACE
+#define MYTRACE MYDBG
+#else
+#define MYTRACE(...)
+#endif
+
+namespace bus
+{
+
+//! Value returned when reading past the end of the register file
+static const uint8_t s_pad = 0xFF;
+//! Sink for data written past the end of the register file
+static uint8_t s_discard;
+
+void I2CRegisterSlave::Start(uint8_t address)
+{
+    ASSERT(!running);
+    MYDBG("Starting at %02X, %d registers", address, size);
+
+    rxDma = LDMA->GetI2CChannel(i2c.Index(), LDMAChannel::I2CSignal::RxDataValid, false);
+    txDma = LDMA->GetI2CChannel(i2c.Index(), LDMAChannel::I2CSignal::TxFree, false);
+    rxDma.DoneHandler(GetDelegate(this, &I2CRegisterSlave::PointerReceived));
+    rxDma.EnableDoneInterrupt();
+
+    i2c.SlaveAddress(address);
+    i2c.Setup(::I2C::SlaveEnable);
+    i2c.ClearFlags();
+    i2c.IEN = I2C_IF_ADDR | I2C_IF_RSTART | I2C_IF_SSTOP | I2C_IF_BUSERR | I2C_IF_ARBLOST;
+    i2c.ClaimIRQHandler(GetDelegate(this, &I2CRegisterSlave::IRQHandler));
+    i2c.IRQClear();
+    i2c.IRQEnable();
+
+    running = true;
+    kernel::Task::Run(this, &I2CRegisterSlave::Task);
+}
+
+void I2CRegisterSlave::Stop()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    MYDBG("Stopping");
+    i2c.IRQDisable();
+    i2c.IEN = 0;
+    Finish();
+    EFM32_BITCLR_REG(i2c.CTRL, I2C_CTRL_SLAVE);
+    i2c.ReleaseIRQHandler();
+    rxDma.Release();
+    txDma.Release();
+    running = false;
+    dirty = true;   // wakes up the task
+}
+
+async(I2CRegisterSlave::Task)
+async_def()
+{
+    for (;;)
+    {
+        await_signal(dirty);
+        if (!running)
+        {
+            break;
+        }
+
+        size_t start, end;
+        i2c.IRQDisable();
+        start = dirtyStart;
+        end = dirtyEnd;
+        dirty = false;
+        i2c.IRQEnable();
+
+        MYTRACE("Modified %d+%d", start, end - start);
+        if (handler)
+        {
+            handler(start, end - start);
+        }
+    }
+
+    MYDBG("Finished");
+}
+async_end
+
+/*!
+ * Handles the bus conditions, data is moved exclusively by the LDMA
+ */
+void I2CRegisterSlave::IRQHandler()
+{
+    auto flags = i2c.ClearFlags();
+
+    if (flags.arbitrationLost || flags.busError)
+    {
+        // see errata, the slave must be reset to avoid SCL hang
+        i2c.Abort();
+        Finish();
+        return;
+    }
+
+    if (flags.repeatedStart || flags.slaveStop)
+    {
+        Finish();
+    }
+
+    if (flags.address)
+    {
+        Address(i2c.Receive());
+    }
+}
+
+//! Starts serving a request after the slave address has been matched
+void I2CRegisterSlave::Address(uint8_t address)
+{
+    if (!active)
+    {
+        // the LDMA needs the HF clock
+        active = true;
+        PLATFORM_DEEP_SLEEP_DISABLE();
+    }
+
+    if (GETBIT(address, 0))
+    {
+        // master reads from the pointer, padding past the end of the registers
+        txStart = pointer;
+        txDesc[1].SetTransfer(&s_pad, &i2c.TXDATA, LDMADescriptor::MaximumTransferSize, LDMADescriptor::P2P | LDMADescriptor::UnitByte, LDMALink::Self);
+        if (pointer < size)
+        {
+            txDesc[0].SetTransfer(regs + pointer, &i2c.TXDATA, size - pointer, LDMADescriptor::M2P | LDMADescriptor::UnitByte, LDMALink::Next);
+            txDma.LinkLoad(txDesc[0]);
+        }
+        else
+        {
+            txDma.LinkLoad(txDesc[1]);
+        }
+        txActive = true;
+        i2c.ACK();
+    }
+    else
+    {
+        // master writes, the first byte is the new pointer value
+        rxDesc[0].SetTransfer(&i2c.RXDATA, &pointerRx, 1, LDMADescriptor::P2M | LDMADescriptor::UnitByte | LDMADescriptor::SetDone);
+        rxDma.LinkLoad(rxDesc[0]);
+        rxState = RxState::Pointer;
+        i2c.ACK();
+        EFM32_BITSET_REG(i2c.CTRL, I2C_CTRL_AUTOACK);
+    }
+}
+
+//! Called from the LDMA interrupt handler after the pointer byte of a write has been received
+void I2CRegisterSlave::PointerReceived()
+{
+    if (rxState != RxState::Pointer)
+    {
+        return;
+    }
+
+    pointer = pointerRx;
+    rxDesc[1].SetTransfer(&i2c.RXDATA, &s_discard, LDMADescriptor::MaximumTransferSize, LDMADescriptor::P2P | LDMADescriptor::UnitByte, LDMALink::Self);
+    if (pointer < size)
+    {
+        rxDesc[0].SetTransfer(&i2c.RXDATA, regs + pointer, size - pointer, LDMADescriptor::P2M | LDMADescriptor::UnitByte, LDMALink::Next);
+        rxDma.LinkLoad(rxDesc[0]);
+    }
+    else
+    {
+        rxDma.LinkLoad(rxDesc[1]);
+    }
+    rxState = RxState::Data;
+}
+
+/*!
+ * Ends the current request on a STOP or repeated START condition
+ *
+ * The number of bytes transferred is derived from the position of the LDMA
+ * channel, the pointer is advanced accordingly
+ */
+void I2CRegisterSlave::Finish()
+{
+    if (rxState != RxState::Idle)
+    {
+        rxDma.Disable();
+        EFM32_BITCLR_REG(i2c.CTRL, I2C_CTRL_AUTOACK);
+        i2c.RxClearBuffer();
+
+        if (rxState == RxState::Data && pointer < size)
+        {
+            auto dst = (uint8_t*)rxDma.RootDescriptor().Destination();
+            size_t end = dst >= regs + pointer && dst <= regs + size ? dst - regs : size;
+            if (end > pointer)
+            {
+                MarkDirty(pointer, end);
+                pointer = end;
+            }
+        }
+        rxState = RxState::Idle;
+    }
+
+    if (txActive)
+    {
+        txDma.Disable();
+        if (txStart < size)
+        {
+            // the byte still waiting in the buffer has not been read by the master
+            auto src = (const uint8_t*)txDma.RootDescriptor().Source();
+            size_t end = src >= regs + txStart && src <= regs + size ? src - regs : size;
+            if (!i2c.TxEmpty() && end > txStart)
+            {
+                end--;
+            }
+            pointer = end;
+        }
+        i2c.TxClearBuffer();
+        txActive = false;
+    }
+
+    if (active)
+    {
+        active = false;
+        PLATFORM_DEEP_SLEEP_ENABLE();
+    }
+}
+
+void I2CRegisterSlave::MarkDirty(size_t start, size_t end)
+{
+    if (dirty)
+    {
+        // merge with the range not yet reported
+        dirtyStart = std::min(size_t(dirtyStart), start);
+        dirtyEnd = std::max(size_t(dirtyEnd), end);
+    }
+    else
+    {
+        dirtyStart = start;
+        dirtyEnd = end;
+        dirty = true;
+    }
+}
+
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32/bus/I2CRegisterSlave.h
+ *
+ * Memory-mapped register file served over I2C by the LDMA
+ */
+
+#pragma once
+
+#include <base/base.h>
+
+#include <hw/I2C.h>
+#include <hw/LDMA.h>
+
+namespace bus
+{
+
+/*!
+ * Exposes a block of memory as a register file of an I2C slave device
+ *
+ * The first byte of every write sets the register pointer, the following
+ * bytes are stored at the pointer, which auto-increments. Reads return
+ * data starting at the current pointer, which also auto-increments.
+ * Reads past the end of the register file return 0xFF, writes past
+ * the end are discarded.
+ *
+ * The bus protocol is handled entirely in the I2C and LDMA interrupt
+ * handlers, the data is moved by the LDMA. The task wakes up only after
+ * a write has modified some registers, to report the modified range.
+ *
+ * @note The slave owns the I2C peripheral and two LDMA channels while it
+ * is running, the I2C cannot be used for anything else in the meantime
+ * (transactions started on it assert), its interrupt handling is restored
+ * when the slave is stopped
+ */
+class I2CRegisterSlave
+{
+public:
+    //! Handler called from the task with the offset and length of registers modified by the master
+    typedef Delegate<void, size_t, size_t> WriteHandler;
+
+    I2CRegisterSlave(::I2C& i2c, Buffer registers)
+        : i2c(i2c), regs((uint8_t*)registers.Pointer()), size(registers.Length())
+    {
+        ASSERT(size && size <= 256);
+    }
+
+    //! Sets the handler called after a write modifies some registers
+    void OnWrite(WriteHandler handler) { this->handler = handler; }
+
+    //! Starts serving the registers at the specified slave address
+    void Start(uint8_t address);
+    //! Stops serving the registers
+    void Stop();
+
+    //! Gets the current value of the register pointer
+    uint8_t Pointer() const { return pointer; }
+
+private:
+    enum struct RxState : uint8_t
+    {
+        Idle, Pointer, Data,
+    };
+
+    ::I2C& i2c;
+    uint8_t* regs;
+    uint16_t size;
+    WriteHandler handler;
+
+    LDMAChannelHandle rxDma, txDma;
+    LDMADescriptor rxDesc[2], txDesc[2];
+
+    uint8_t pointer = 0;
+    uint8_t pointerRx;
+    uint8_t txStart;
+    RxState rxState = RxState::Idle;
+    bool txActive = false;
+    bool active = false;
+    bool running = false;
+    bool dirty = false;
+    uint16_t dirtyStart, dirtyEnd;
+
+    async(Task);
+    void IRQHandler();
+    void PointerReceived();
+    void Address(uint8_t address);
+    void Finish();
+    void MarkDirty(size_t start, size_t end);
+};
+
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32/bus/I2CScanScheduler.cpp
+ */
+
+#include "I2CScanScheduler.h"
+
+//#define I2C_SCAN_TRACE    1
+
+#define MYDBG(fmt, ...)    DBGL("I2C%d_SCAN: " fmt, i2c.Index(), ## __VA_ARGS__)
+
+#if I2C_SCAN_TRACE
+#define MYTRACE MYDBG
+#else
+#define MYTRACE(...)
+#endif
+
+namespace bus
+{
+
+void I2CScanScheduler::Add(Poll& poll)
+{
+    ASSERT(poll.period && poll.length);
+
+    poll.due = MONO_CLOCKS;
+    poll.scheduled = false;
+    poll.valid = false;
+    poll.next = polls;
+    polls = &poll;
+    changed = true;
+
+    if (!running)
+    {
+        running = true;
+        kernel::Task::Run(this, &I2CScanScheduler::Task);
+    }
+}
+
+void I2CScanScheduler::Remove(Poll& poll)
+{
+    for (Poll** pp = &polls; *pp; pp = &(*pp)->next)
+    {
+        if (*pp == &poll)
+        {
+            *pp = poll.next;
+            poll.scheduled = false;
+            changed = true;
+            return;
+        }
+    }
+}
+
+/*!
+ * Single task executing all the registered reads
+ *
+ * The task sleeps until the earliest read is due, then performs all reads
+ * that are due within the scheduling window in one bus session
+ */
+async(I2CScanScheduler::Task)
+async_def(
+    size_t count;
+    unsigned waitMs;
+)
+{
+    MYDBG("Starting");
+
+    while (polls)
+    {
+        changed = false;
+
+        {
+            mono_t wait;
+            if (!(f.count = Prepare(wait)))
+            {
+                // round up, waking up early would just cause another wait
+                f.waitMs = (wait + MonoFromMilliseconds(1) - 1) / MonoFromMilliseconds(1);
+            }
+        }
+
+        if (!f.count)
+        {
+            MYTRACE("Sleeping %dms", f.waitMs);
+            await_signal_ms(changed, f.waitMs);
+            continue;
+        }
+
+        MYTRACE("Session of %d segments", f.count);
+        await(i2c.Transfer, messages, f.count);
+        Complete();
+    }
+
+    MYDBG("Finished");
+    running = false;
+}
+async_end
+
+/*!
+ * Selects all reads due within the scheduling window and builds the segments
+ * of the bus session for them
+ *
+ * @returns The number of segments to execute, or zero if no read is due yet,
+ * in which case @p wait receives the time until the earliest read
+ */
+size_t I2CScanScheduler::Prepare(mono_t& wait)
+{
+    mono_t now = MONO_CLOCKS;
+    mono_t next = polls->due;
+    for (auto p = polls->next; p; p = p->next)
+    {
+        if (IsDue(p->due, next))
+        {
+            next = p->due;
+        }
+    }
+
+    if (!IsDue(next, now))
+    {
+        wait = next - now;
+        return 0;
+    }
+
+    size_t count = 0;
+    mono_t limit = now + window;
+    for (auto p = polls; p; p = p->next)
+    {
+        size_t segments = p->commandLength ? 2 : 1;
+        if (!IsDue(p->due, limit) || count + segments > I2C_SCAN_MAX_MESSAGES)
+        {
+            // reads that don't fit will be performed in the next session right away
+            continue;
+        }
+
+        if (p->commandLength)
+        {
+            messages[count++] = ::I2C::Message::Write(p->address, Span(p->command, p->commandLength));
+        }
+        p->message = count;
+        messages[count++] = ::I2C::Message::Read(p->address, Buffer(p->data, p->length), ::I2C::Message::FlagStop);
+        p->scheduled = true;
+    }
+
+    return count;
+}
+
+//! Reports the results of the finished session and reschedules the reads
+void I2CScanScheduler::Complete()
+{
+    mono_t now = MONO_CLOCKS;
+    Poll* next;
+    for (auto p = polls; p; p = next)
+    {
+        // the handler may remove the poll
+        next = p->next;
+        if (!p->scheduled)
+        {
+            continue;
+        }
+
+        bool ok = messages[p->message].transferred == p->length;
+        p->scheduled = false;
+        p->valid = ok;
+        p->due += p->period;
+        if (IsDue(p->due, now))
+        {
+            // the read is late (e.g. the bus was busy), don't try to catch up
+            p->due = now + p->period;
+        }
+
+        if (!ok)
+        {
+            MYDBG("Read from %02X failed", p->address);
+        }
+
+        if (p->handler)
+        {
+            p->handler(*p, ok);
+        }
+    }
+}
+
+}
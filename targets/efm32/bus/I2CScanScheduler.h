@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32/bus/I2CScanScheduler.h
+ *
+ * Periodic reads of multiple I2C devices grouped into shared bus sessions
+ */
+
+#pragma once
+
+#include <base/base.h>
+
+#include <hw/I2C.h>
+
+#ifndef I2C_SCAN_WINDOW
+//! Default number of milliseconds by which a periodic read can be performed
+//! ahead of its due time to be merged with a session of other reads
+#define I2C_SCAN_WINDOW             5
+#endif
+
+#ifndef I2C_SCAN_MAX_MESSAGES
+//! Maximum number of transaction segments executed in a single bus session,
+//! each read uses one or two segments depending on the presence of a command
+#define I2C_SCAN_MAX_MESSAGES       16
+#endif
+
+namespace bus
+{
+
+/*!
+ * Performs periodic reads of multiple I2C devices from a single task
+ *
+ * Instead of every driver waking up on its own and acquiring the bus,
+ * the drivers register their periodic reads with the scheduler. All reads
+ * that are due within the scheduling window are executed as a single
+ * @ref ::I2C::Transfer, i.e. one bus lock and one wakeup from deep sleep,
+ * longer reads are performed by the LDMA. The results are stored directly
+ * in the buffers of the individual reads and the drivers are notified
+ * using their handlers.
+ */
+class I2CScanScheduler
+{
+public:
+    I2CScanScheduler(::I2C& i2c, unsigned windowMs = I2C_SCAN_WINDOW)
+        : i2c(i2c), window(MonoFromMilliseconds(windowMs)) {}
+    I2CScanScheduler(::I2C* i2c, unsigned windowMs = I2C_SCAN_WINDOW)
+        : i2c(*i2c), window(MonoFromMilliseconds(windowMs)) {}
+
+    //! A single periodic read, must remain valid while registered with the scheduler
+    class Poll
+    {
+    public:
+        //! Handler called from the scheduler task after each read, with the success flag
+        typedef Delegate<void, Poll&, bool> Handler;
+
+        //! Prepares a read of the specified number of bytes, optionally preceded
+        //! by a write of the command (typically a register address) with a repeated start
+        void Setup(uint8_t address, Span command, Buffer data, unsigned periodMs, Handler handler)
+        {
+            ASSERT(command.Length() <= 0xFFFF && data.Length() <= 0xFFFF);
+            this->address = address;
+            this->command = command.Pointer();
+            this->commandLength = command.Length();
+            this->data = data.Pointer();
+            this->length = data.Length();
+            this->period = MonoFromMilliseconds(periodMs);
+            this->handler = handler;
+        }
+
+        //! Gets the buffer where the data is read
+        Buffer Data() const { return Buffer(data, length); }
+        //! Checks if the last read was successful
+        bool IsValid() const { return valid; }
+
+    private:
+        Poll* next;
+        const void* command;
+        void* data;
+        uint16_t commandLength;
+        uint16_t length;
+        uint8_t address;
+        uint8_t message;
+        bool scheduled = false;
+        bool valid = false;
+        mono_t period;
+        mono_t due;
+        Handler handler;
+
+        friend class I2CScanScheduler;
+    };
+
+    //! Registers the periodic read, the first read is performed as soon as possible
+    void Add(Poll& poll);
+    //! Unregisters the periodic read
+    //! @note If a session is in progress, the data buffer may still be written
+    //! by it, but the handler will not be called anymore
+    void Remove(Poll& poll);
+
+private:
+    ::I2C& i2c;
+    Poll* polls = NULL;
+    mono_t window;
+    bool running = false;
+    bool changed = false;
+    ::I2C::Message messages[I2C_SCAN_MAX_MESSAGES];
+
+    async(Task);
+    size_t Prepare(mono_t& wait);
+    void Complete();
+
+    static bool IsDue(mono_t due, mono_t limit) { return (int32_t)(limit - due) >= 0; }
+};
+
+}
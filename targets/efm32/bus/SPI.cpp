@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32/bus/SPI.cpp
+ */
+
+#if !EFM32_USE_GPIO_SPI
+
+#include "SPI.h"
+
+namespace bus
+{
+
+async(SPI::Acquire, ChipSelect cs, const SPIDevice& device, Timeout timeout)
+async_def()
+{
+    if (!await(usart.BindCs, cs.loc, timeout))
+    {
+        async_return(false);
+    }
+
+    Configure(device);
+    async_return(true);
+}
+async_end
+
+async(SPI::Poll, Span command, uint8_t mask, uint8_t value, size_t batch, size_t maxBatches, unsigned timeoutMs, unsigned intervalMs)
+async_def(
+    Descriptor desc[2];
+    uint8_t status;
+    mono_t start;
+)
+{
+    ASSERT(batch > 0 && batch <= MaximumTransferSize());
+    f.start = MONO_CLOCKS;
+
+    while (maxBatches--)
+    {
+        f.desc[0].Transmit(command);
+        f.desc[1].ReceiveSame(&f.status, batch);
+        await(usart.SyncTransfer, f.desc);
+
+        if ((f.status & mask) == value)
+        {
+            async_return(true);
+        }
+
+        if (timeoutMs != ~0u && MONO_CLOCKS - f.start >= MonoFromMilliseconds(timeoutMs))
+        {
+            break;
+        }
+
+        if (intervalMs)
+        {
+            async_delay_ms(intervalMs);
+        }
+    }
+
+    async_return(false);
+}
+async_end
+
+void SPI::Configure(const SPIDevice& dev)
+{
+    ASSERT(dev.frequency);
+
+    if (device == &dev)
+    {
+        return;
+    }
+
+    device = &dev;
+
+    uint32_t ctrl = (usart.CTRL & ~(USART_CTRL_CLKPOL | USART_CTRL_CLKPHA | USART_CTRL_MSBF)) |
+        (dev.ClockIdleHigh() ? USART_CTRL_CLKPOL : 0) |
+        (dev.SampleTrailing() ? USART_CTRL_CLKPHA : 0) |
+        (dev.order == SPIDevice::MSBFirst ? USART_CTRL_MSBF : 0);
+    if (usart.CTRL != ctrl)
+    {
+        usart.CTRL = ctrl;
+    }
+
+    if (usart.DataBits() != dev.frameBits)
+    {
+        usart.DataBits(dev.frameBits);
+    }
+
+    // integer divider only (no fractional part in synchronous mode), rounded so the device maximum is not exceeded
+    unsigned half = dev.frequency << 1;
+    unsigned div = std::max((usart.ClockFrequency() + half - 1) / half, 1u) << USART::ClkDivFracBits;
+    if (usart.ClkDiv() != div)
+    {
+        usart.ClkDiv(div);
+    }
+}
+
+}
+
+#endif
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "SPIDevice.h"
+
 #if EFM32_USE_GPIO_SPI
 
 #include "SPI_GPIO.h"
@@ -24,6 +26,7 @@ namespace bus
 class SPI
 {
     ::USART& usart;
+    const SPIDevice* device = NULL;
 
 public:
     constexpr SPI(USART& usart)
@@ -51,16 +54,37 @@ public:
     //! Retrieves a ChipSelect handle for the specified GPIO pin for the current USART
     ChipSelect GetChipSelect(GPIOPin pin) { return ChipSelect(usart.GetCsLocation(pin)); }
     //! Acquires the bus for the device identified by the specified @ref ChipSelect
-    async(Acquire, ChipSelect cs, Timeout timeout = Timeout::Infinite) { return async_forward(usart.BindCs, cs.loc, timeout); }
+    //! @note The caller may reconfigure the USART directly, so the last applied device configuration is forgotten
+    async(Acquire, ChipSelect cs, Timeout timeout = Timeout::Infinite) { InvalidateConfiguration(); return async_forward(usart.BindCs, cs.loc, timeout); }
+    //! Acquires the bus for the device identified by the specified @ref ChipSelect and applies its bus configuration
+    async(Acquire, ChipSelect cs, const SPIDevice& device, Timeout timeout = Timeout::Infinite);
     //! Releases the bus
     void Release() { usart.ReleaseCs(); }
 
+    //! Applies the bus configuration of the specified device, registers are written only when changed
+    void Configure(const SPIDevice& device);
+    //! Forgets the last applied device configuration, to be used after the USART is reconfigured directly
+    void InvalidateConfiguration() { device = NULL; }
+
     //! Performs a single SPI transfer
     async(Transfer, Descriptor& descriptor) { return async_forward(usart.SyncTransfer, &descriptor, 1); }
     //! Performs a chain of SPI transfers
     async(Transfer, Descriptor* descriptors, size_t count) { return async_forward(usart.SyncTransfer, descriptors, count); }
     //! Performs a chain of SPI transfers
     template<size_t n> ALWAYS_INLINE async(Transfer, Descriptor (&descriptors)[n]) { return async_forward(usart.SyncTransfer, descriptors, n); }
+
+    /*!
+     * Polls a status register until (status & mask) == value
+     *
+     * Each batch is a single DMA transfer sending the @p command and then
+     * clocking in @p batch status bytes into the same location, the task
+     * only wakes up to check the last one. Devices that stream the status
+     * register continuously while CS is held (e.g. SPI flash RDSR) can use
+     * large batches, others should use a batch size of 1 and an interval.
+     *
+     * @returns true if the status matched, false if @p maxBatches or @p timeoutMs was exhausted
+     */
+    async(Poll, Span command, uint8_t mask, uint8_t value, size_t batch, size_t maxBatches = ~0u, unsigned timeoutMs = ~0u, unsigned intervalMs = 0);
 };
 
 }
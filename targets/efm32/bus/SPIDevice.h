@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32/bus/SPIDevice.h
+ *
+ * Bus configuration profile of a single SPI device
+ */
+
+#pragma once
+
+#include <base/base.h>
+
+namespace bus
+{
+
+//! Bus parameters required by a single device, applied by SPI::Acquire
+struct SPIDevice
+{
+    enum Mode : uint8_t
+    {
+        Mode0,      //!< CPOL = 0, CPHA = 0
+        Mode1,      //!< CPOL = 0, CPHA = 1
+        Mode2,      //!< CPOL = 1, CPHA = 0
+        Mode3,      //!< CPOL = 1, CPHA = 1
+    };
+
+    enum Order : uint8_t
+    {
+        MSBFirst,
+        LSBFirst,
+    };
+
+    explicit constexpr SPIDevice(unsigned frequency, Mode mode = Mode0, Order order = MSBFirst, uint8_t frameBits = 8)
+        : frequency(frequency), mode(mode), order(order), frameBits(frameBits) {}
+
+    unsigned frequency;     //!< Maximum clock frequency supported by the device
+    Mode mode;              //!< Clock polarity and phase
+    Order order;            //!< Bit order
+    uint8_t frameBits;      //!< Number of bits in a frame
+
+    //! Checks if the clock is high when idle
+    constexpr bool ClockIdleHigh() const { return mode & 2; }
+    //! Checks if data is sampled on the trailing clock edge
+    constexpr bool SampleTrailing() const { return mode & 1; }
+};
+
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32/bus/SPIQueue.cpp
+ */
+
+#include "SPIQueue.h"
+
+namespace bus
+{
+
+void SPIQueue::Init()
+{
+    auto dmaRx = LDMA->GetUSARTChannel(usart.Index(), LDMAChannel::USARTSignal::RxDataValid, false);
+    auto dmaTx = LDMA->GetUSARTChannel(usart.Index(), LDMAChannel::USARTSignal::TxFree, false);
+    // the SYNC bit signals that the bus is free for the next transaction
+    syncBit = LDMA->AllocateSync();
+    LDMA->SetSync(syncBit);
+    dmaRx.DoneHandler(GetDelegate(this, &SPIQueue::DoneHandler));
+    dmaRx.EnableDoneInterrupt();
+    rx.Reset(dmaRx);
+    tx.Reset(dmaTx);
+}
+
+void SPIQueue::Submit(Transaction& t)
+{
+    ASSERT(t.count > 0);
+
+    if (!rx.Channel().IsValid())
+    {
+        Init();
+    }
+
+    uint8_t sync = BIT(syncBit);
+    auto& port = t.cs.Port();
+
+    t.txHead[0] = LDMADescriptor::Sync(0, 0, sync, sync, LDMADescriptor::Start, &t.txHead[1]);
+    t.txHead[1] = LDMADescriptor::Sync(0, sync, 0, 0, LDMADescriptor::Start, &t.txHead[2]);
+    t.txHead[2].SetImmediateWrite(t.cs.Mask(), port.BitClearPtr(), &t.descriptors[0].tx);
+    t.txHead[2].CTRL |= LDMADescriptor::Start;
+
+    size_t i;
+    for (i = 0; i < t.count - 1; i++)
+    {
+        usart.SyncTransferBind(t.descriptors[i]);
+        t.descriptors[i].tx.Link(&t.descriptors[i + 1].tx);
+        t.descriptors[i].rx.Link(&t.descriptors[i + 1].rx);
+    }
+
+    usart.SyncTransferBind(t.descriptors[i]);
+    t.descriptors[i].rx.Link(&t.rxTail[0]);
+
+    // the RX channel has no pending request after the last byte, the tail must start itself
+    t.rxTail[0].SetImmediateWrite(t.cs.Mask(), port.BitSetPtr(), &t.rxTail[1]);
+    t.rxTail[0].CTRL |= LDMADescriptor::Start;
+    t.rxTail[1] = LDMADescriptor::Sync(sync, 0, 0, 0, LDMADescriptor::Start | LDMADescriptor::SetDone);
+
+    t.next = NULL;
+    t.done = false;
+
+    // the LDMA needs the HF clock until the transaction completes
+    PLATFORM_DEEP_SLEEP_DISABLE();
+
+    auto primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (tail)
+    {
+        tail->next = &t;
+    }
+    else
+    {
+        head = &t;
+    }
+    tail = &t;
+
+    // RX must be ready before the TX chain can start clocking data
+    rx.Append(&t.descriptors[0].rx, &t.rxTail[1]);
+    tx.Append(&t.txHead[0], &t.descriptors[t.count - 1].tx);
+
+    __set_PRIMASK(primask);
+}
+
+async(SPIQueue::Wait, Transaction& t, Timeout timeout)
+async_def()
+{
+    async_return(await_signal_timeout(t.done, timeout));
+}
+async_end
+
+async(SPIQueue::Transfer, Transaction& t)
+async_def()
+{
+    Submit(t);
+    await(Wait, t);
+}
+async_end
+
+//! Called from the LDMA interrupt handler when the RX chain of a transaction completes
+void SPIQueue::DoneHandler()
+{
+    while (auto t = head)
+    {
+        // retire the RX chain up to the end of the transaction
+        LDMADescriptor* desc;
+        while ((desc = rx.Retire()) && desc != &t->rxTail[1]);
+        if (!desc)
+        {
+            // still running
+            break;
+        }
+
+        // the TX chain of the transaction is certainly done as well
+        auto* txLast = &t->descriptors[t->count - 1].tx;
+        while ((desc = tx.Retire()) && desc != txLast);
+
+        if (!(head = t->next))
+        {
+            tail = NULL;
+        }
+        t->done = true;
+        PLATFORM_DEEP_SLEEP_ENABLE();
+    }
+}
+
+}
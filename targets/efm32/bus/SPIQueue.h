@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32/bus/SPIQueue.h
+ *
+ * Queue of SPI transactions executed back to back by the LDMA
+ */
+
+#pragma once
+
+#include <base/base.h>
+
+#include <hw/USART.h>
+#include <hw/LDMA.h>
+
+namespace bus
+{
+
+/*!
+ * Executes queued SPI transactions on a USART entirely by the LDMA
+ *
+ * Each transaction consists of a GPIO chip select and a list of
+ * USART::SyncTransferDescriptors. Transactions submitted while another one
+ * is running are appended to the running LDMA chains, the CS pin is
+ * driven by immediate write descriptors and the TX chain of the next
+ * transaction is held by a SYNC descriptor until the RX chain of the
+ * previous one has deasserted its CS.
+ *
+ * @note The queue owns two LDMA channels and one SYNC bit for its whole
+ * lifetime, USART::SyncTransfer must not be used on the same USART
+ */
+class SPIQueue
+{
+public:
+    constexpr SPIQueue(USART& usart)
+        : usart(usart) {}
+    constexpr SPIQueue(USART* usart)
+        : usart(*usart) {}
+
+    //! Represents an single SPI transfer step
+    using Descriptor = USART::SyncTransferDescriptor;
+
+    //! A single queued transaction, must remain valid until it completes
+    class Transaction
+    {
+    public:
+        //! Prepares the transaction for the specified active-low CS pin and transfer steps
+        void Setup(GPIOPin cs, Descriptor* descriptors, size_t count)
+        {
+            this->cs = cs;
+            this->descriptors = descriptors;
+            this->count = count;
+        }
+        //! Prepares the transaction for the specified active-low CS pin and transfer steps
+        template<size_t n> void Setup(GPIOPin cs, Descriptor (&descriptors)[n]) { Setup(cs, descriptors, n); }
+
+        //! Checks if the transaction has been completed
+        bool IsDone() const { return done; }
+
+    private:
+        Transaction* next;
+        GPIOPin cs = GPIOPin(NULL, 0);
+        Descriptor* descriptors;
+        size_t count;
+        LDMADescriptor txHead[3];   // wait for previous CS deassert, clear SYNC, assert CS
+        LDMADescriptor rxTail[2];   // deassert CS, set SYNC + done
+        volatile bool done;
+
+        friend class SPIQueue;
+    };
+
+    //! Queues the transaction for execution, returns immediately
+    //! @note Deep sleep is prevented from submission until the transaction completes
+    void Submit(Transaction& transaction);
+    //! Waits for the completion of a previously submitted transaction
+    async(Wait, Transaction& transaction, Timeout timeout = Timeout::Infinite);
+    //! Queues the transaction and waits for its completion
+    async(Transfer, Transaction& transaction);
+
+    //! Checks if there are no transactions in the queue
+    bool IsIdle() const { return !head; }
+
+private:
+    USART& usart;
+    LDMAChain rx, tx;
+    Transaction* head = NULL;
+    Transaction* tail = NULL;
+    uint8_t syncBit;
+
+    void Init();
+    void DoneHandler();
+};
+
+}
@@ -16,6 +16,7 @@ namespace bus
 async(SPI_GPIO::Transfer, Descriptor* descriptors, size_t count)
 async_def_sync()
 {
+    mosiLevel = mosi.Port().DOUT & mosiMask;
     cs.Res();
     while (count--)
     {
@@ -30,6 +31,13 @@ async_def_sync()
                     descriptors->data[0] = ReadByte();
                 break;
             case Descriptor::Write:
+#if EFM32_GPIO_SPI_DMA
+                if (pattern && descriptors->size >= EFM32_GPIO_SPI_DMA_THRESHOLD)
+                {
+                    WritePattern(descriptors->data, descriptors->size);
+                    break;
+                }
+#endif
                 for (size_t i = 0; i < descriptors->size; i++)
                     WriteByte(descriptors->data[i]);
                 break;
@@ -46,35 +54,120 @@ async_end
 
 static ALWAYS_INLINE void clockdelay()
 {
-    __NOP(); __NOP();
+    for (unsigned i = 0; i < EFM32_GPIO_SPI_DELAY; i++)
+    {
+        __NOP();
+    }
 }
 
 uint8_t SPI_GPIO::ReadByte()
 {
-    int res = 0;
-    for (int i = 0; i < 8; i++)
+    auto tgl = clkTgl;
+    auto in = misoIn;
+    auto mask = clkMask;
+    auto bit = misoBit;
+    uint32_t res = 0;
+
+    if (!miso.IsValid())
     {
-        clockdelay();
-        clk.Toggle();
-        clockdelay();
-        res = (res << 1) | miso;
-        clk.Toggle();
+        // nothing to sample, just generate the clock
+        for (unsigned i = 0; i < 8; i++)
+        {
+            clockdelay();
+            *tgl = mask;
+            clockdelay();
+            *tgl = mask;
+        }
+        return 0;
     }
+
+#define READ_BIT() \
+    clockdelay(); \
+    *tgl = mask; \
+    clockdelay(); \
+    res = (res << 1) | ((*in >> bit) & 1); \
+    *tgl = mask;
+
+    READ_BIT(); READ_BIT(); READ_BIT(); READ_BIT();
+    READ_BIT(); READ_BIT(); READ_BIT(); READ_BIT();
+
+#undef READ_BIT
+
     return res;
 }
 
 void SPI_GPIO::WriteByte(uint8_t byte)
 {
-    for (int i = 7; i >= 0; i--)
+    auto tgl = clkTgl;
+    auto mask = clkMask;
+    auto dtgl = mosiTgl;
+    auto dmask = mosiMask;
+    // bit n is set when it differs from the previous one (or the current level of MOSI for bit 7)
+    uint32_t diff = (byte ^ (byte >> 1) ^ (mosiLevel << 7)) & 0xFF;
+    mosiLevel = byte & 1;
+
+#define WRITE_BIT(n) \
+    if (GETBIT(diff, n)) { *dtgl = dmask; } \
+    clockdelay(); \
+    *tgl = mask; \
+    clockdelay(); \
+    *tgl = mask;
+
+    WRITE_BIT(7); WRITE_BIT(6); WRITE_BIT(5); WRITE_BIT(4);
+    WRITE_BIT(3); WRITE_BIT(2); WRITE_BIT(1); WRITE_BIT(0);
+
+#undef WRITE_BIT
+}
+
+#if EFM32_GPIO_SPI_DMA
+
+/*!
+ * Transmits data by letting the LDMA write a precomputed sequence of
+ * toggle masks to the DOUTTGL register
+ *
+ * Every bit is two words - the first one changes MOSI if needed and
+ * produces the falling edge of the previous bit, the second one the rising
+ * edge. Data longer than the pattern buffer is sent in multiple chunks.
+ */
+void SPI_GPIO::WritePattern(const uint8_t* data, size_t length)
+{
+    uint32_t fall = 0;
+
+    while (length)
     {
-        mosi.Set(GETBIT(byte, i));
-        clockdelay();
-        clk.Toggle();
-        clockdelay();
-        clk.Toggle();
+        size_t bytes = std::min(length, patternWords / 16);
+        uint32_t* p = pattern;
+
+        for (size_t i = 0; i < bytes; i++)
+        {
+            uint8_t byte = data[i];
+            for (int n = 7; n >= 0; n--)
+            {
+                bool bit = GETBIT(byte, n);
+                *p++ = fall | (bit != mosiLevel ? mosiMask : 0);
+                *p++ = clkMask;
+                fall = clkMask;
+                mosiLevel = bit;
+            }
+        }
+
+        desc.SetTransfer(pattern, clkTgl, p - pattern, LDMADescriptor::M2P | LDMADescriptor::UnitWord |
+            (paced ? LDMADescriptor::BlockSize1 : LDMADescriptor::Start | LDMADescriptor::TransferModeAll | LDMADescriptor::BlockSizeAll));
+        dma.LinkLoad(desc);
+
+        data += bytes;
+        length -= bytes;
+
+        while (dma.IsEnabled());
     }
+
+    // falling edge of the last bit
+    clockdelay();
+    *clkTgl = clkMask;
 }
 
+#endif
+
 }
 
 #endif
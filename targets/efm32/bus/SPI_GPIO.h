@@ -13,6 +13,27 @@
 
 #include <hw/GPIO.h>
 
+#include "SPIDevice.h"
+
+#ifndef EFM32_GPIO_SPI_DELAY
+//! Number of NOPs inserted after each clock edge, determines the resulting clock rate
+#define EFM32_GPIO_SPI_DELAY    2
+#endif
+
+#ifndef EFM32_GPIO_SPI_DMA
+//! Enables transmitting large blocks by LDMA writing precomputed patterns to the GPIO toggle register
+#define EFM32_GPIO_SPI_DMA      0
+#endif
+
+#if EFM32_GPIO_SPI_DMA
+#include <hw/LDMA.h>
+
+#ifndef EFM32_GPIO_SPI_DMA_THRESHOLD
+//! Minimum length of a transmit-only block that is sent using the LDMA
+#define EFM32_GPIO_SPI_DMA_THRESHOLD    16
+#endif
+#endif
+
 namespace bus
 {
 
@@ -20,6 +41,14 @@ class SPI_GPIO
 {
     GPIOPin clk, mosi, miso, cs;
 
+    // cached register pointers and masks, so the bit loops do not have to dereference the pins
+    volatile uint32_t* clkTgl;
+    volatile uint32_t* mosiTgl;
+    const volatile uint32_t* misoIn;
+    uint32_t clkMask, mosiMask;
+    uint8_t misoBit;
+    bool mosiLevel;
+
     class Descriptor
     {
         uint8_t* data;
@@ -40,9 +69,46 @@ class SPI_GPIO
     uint8_t ReadByte();
     void WriteByte(uint8_t b);
 
+#if EFM32_GPIO_SPI_DMA
+    LDMAChannelHandle dma;
+    LDMADescriptor desc;
+    uint32_t* pattern = NULL;
+    size_t patternWords;
+    bool paced;
+
+    void WritePattern(const uint8_t* data, size_t length);
+#endif
+
 public:
     SPI_GPIO(GPIOPin clk, GPIOPin mosi, GPIOPin miso)
-        : clk(clk), mosi(mosi), miso(miso), cs(Px) {}
+        : clk(clk), mosi(mosi), miso(miso), cs(Px),
+        clkTgl(clk.Port().TogglePtr()), mosiTgl(mosi.Port().TogglePtr()), misoIn(miso.Port().InputPtr()),
+        clkMask(clk.Mask()), mosiMask(mosi.Mask()), misoBit(miso.Mask() ? miso.Index() : 0) {}
+
+#if EFM32_GPIO_SPI_DMA
+    /*!
+     * Enables LDMA transmission of large transmit-only blocks
+     *
+     * Each transmitted bit is expanded into two words written to the
+     * DOUTTGL register of the port, so the CLK and MOSI pins must be on
+     * the same port and the buffer determines how many bytes
+     * (words / 16) are sent per DMA pass. The received data is ignored.
+     *
+     * @param dma Either a software triggered channel, running at the maximum
+     * LDMA rate, or a channel paced by a TIMER request, producing one edge per request
+     * @param paced Must be set when the channel is paced by a peripheral request
+     * @note The CPU waits for the DMA to complete, the benefit is the higher
+     * and steady clock rate, not freeing the CPU
+     */
+    void PatternMode(LDMAChannelHandle dma, Buffer buffer, bool paced = false)
+    {
+        ASSERT(&clk.Port() == &mosi.Port());
+        this->dma = dma;
+        this->paced = paced;
+        pattern = (uint32_t*)buffer.Pointer();
+        patternWords = buffer.Length() / sizeof(uint32_t) & ~15;
+    }
+#endif
 
     friend class SPI;
 };
@@ -62,6 +128,8 @@ public:
     static constexpr size_t MaximumTransferSize() { return ~0u; }
 
     async(Acquire, ChipSelect cs) async_def_sync() { bus.cs = cs; async_return(true); } async_end
+    //! Acquires the bus, the GPIO implementation supports only MSB-first 8-bit frames at a fixed clock rate
+    async(Acquire, ChipSelect cs, const SPIDevice& device) async_def_sync() { ASSERT(device.order == SPIDevice::MSBFirst && device.frameBits == 8); bus.cs = cs; async_return(true); } async_end
     void Release() {}
 
     async(Transfer, Descriptor& descriptor) { return async_forward(Transfer, &descriptor, 1); }
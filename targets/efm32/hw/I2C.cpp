@@ -36,7 +36,32 @@
 #define I2C_TIMEOUT	1000		// timeouts shouldn't normally occur
 #endif
 
+//! Bit for each peripheral whose bus is currently owned
 static uint32_t s_locks;
+//! Bit for each peripheral whose owner is a SlaveWait that can yield the bus while waiting for an address
+static uint32_t s_slaveListen;
+//! Bit for each peripheral serviced by a custom interrupt handler
+static uint32_t s_custom;
+
+//! A task waiting for the bus, lives in the frame of I2C::Acquire
+struct I2CWaiter
+{
+    I2CWaiter* next;
+    mono_t since;
+    I2C::Priority priority;
+    bool granted;
+};
+
+//! Per-bus arbitration state
+static struct
+{
+    I2CWaiter* waiters;
+    mono_t acquired;
+    uint8_t highBurst;
+    I2C::ArbiterStatistics stats;
+} s_arbiter[I2C_COUNT];
+//! Bit for each peripheral that should generate a STOP after the last byte of a DMA read
+static uint32_t s_dmaStop;
 
 async(I2C::Reset)
 async_def(int retry)
@@ -81,9 +106,26 @@ async_def(int retry)
 }
 async_end
 
+void I2C::ClaimIRQHandler(Delegate<void> handler)
+{
+    // the transactions would replace the handler
+    ASSERT(!GETBIT(s_locks, Index()) && !GETBIT(s_custom, Index()));
+    SETBIT(s_custom, Index());
+    Cortex_SetIRQHandler(IRQn(), handler);
+}
+
+void I2C::ReleaseIRQHandler()
+{
+    ASSERT(GETBIT(s_custom, Index()));
+    RESBIT(s_custom, Index());
+    // the transactions rely on the interrupt just waking up the waiting task
+    Cortex_SetIRQWakeup(IRQn());
+}
+
 void I2C::TransactionInit()
 {
     ASSERT(IEN == 0);
+    ASSERT(!GETBIT(s_custom, Index()));
 
     Cortex_SetIRQWakeup(IRQn());
     IRQClear();
@@ -92,23 +134,177 @@ void I2C::TransactionInit()
     PLATFORM_DEEP_SLEEP_DISABLE();
 }
 
+//! Ends the transaction after an operation, unless it is part of a transaction list holding the lock
+void I2C::TransactionEnd(Operation op)
+{
+    if (!op.locked)
+    {
+        TransactionCleanup();
+    }
+}
+
 void I2C::TransactionCleanup()
 {
-    ASSERT(GETBIT(s_locks, Index()));
-    RESBIT(s_locks, Index());
+    Release();
 
     IEN = 0;
     IRQDisable();
     PLATFORM_DEEP_SLEEP_ENABLE();
 }
 
-async(I2C::_Address, Operation op)
+/*!
+ * Acquires the bus for a transaction
+ *
+ * Waiting tasks are queued in FIFO order, high priority waiters ahead
+ * of the normal priority ones. The queue lives in the frames of the
+ * waiting tasks, so a waiter that times out simply removes itself.
+ */
+async(I2C::Acquire, Priority priority, Timeout timeout)
+async_def(
+    I2CWaiter w;
+)
+{
+    {
+        auto& a = s_arbiter[Index()];
+
+        if (!GETBIT(s_locks, Index()))
+        {
+            SETBIT(s_locks, Index());
+            a.stats.acquisitions++;
+            a.acquired = MONO_CLOCKS;
+            async_return(true);
+        }
+
+        a.stats.contended++;
+        f.w.since = MONO_CLOCKS;
+        f.w.priority = priority;
+        f.w.granted = false;
+
+        // insert behind all waiters of the same or higher priority
+        I2CWaiter** pw = &a.waiters;
+        while (*pw && (*pw)->priority >= priority)
+        {
+            pw = &(*pw)->next;
+        }
+        f.w.next = *pw;
+        *pw = &f.w;
+
+        if (GETBIT(s_slaveListen, Index()))
+        {
+            // wake up the SlaveWait holding the bus so it can yield
+            EFM32_IFS(this) = I2C_IF_ADDR;
+        }
+    }
+
+    if (!await_signal_timeout(f.w.granted, timeout) && !f.w.granted)
+    {
+        for (I2CWaiter** pw = &s_arbiter[Index()].waiters; *pw; pw = &(*pw)->next)
+        {
+            if (*pw == &f.w)
+            {
+                *pw = f.w.next;
+                break;
+            }
+        }
+        async_return(false);
+    }
+
+    async_return(true);
+}
+async_end
+
+/*!
+ * Releases the bus, handing it over directly to the next waiter
+ */
+void I2C::Release()
+{
+    ASSERT(GETBIT(s_locks, Index()));
+
+    auto& a = s_arbiter[Index()];
+    mono_t now = MONO_CLOCKS;
+    mono_t hold = now - a.acquired;
+    // a slave waiting for an address doesn't block the bus, it yields to any waiter
+    if (!GETBIT(s_slaveListen, Index()))
+    {
+        if (hold > a.stats.maxHold)
+        {
+            a.stats.maxHold = hold;
+        }
+        if (hold > MonoFromMilliseconds(EFM32_I2C_MAX_HOLD))
+        {
+            DBGCL(Index() ? "I2C1" : "I2C0", "held for %d ticks", hold);
+        }
+    }
+
+    I2CWaiter** pw = &a.waiters;
+    if (!*pw)
+    {
+        RESBIT(s_locks, Index());
+        a.highBurst = 0;
+        return;
+    }
+
+    if ((*pw)->priority == Priority::High)
+    {
+        // don't let a busy high priority device starve everyone else
+        I2CWaiter** pn = pw;
+        while (*pn && (*pn)->priority == Priority::High)
+        {
+            pn = &(*pn)->next;
+        }
+
+        if (!*pn)
+        {
+            a.highBurst = 0;
+        }
+        else if (++a.highBurst > EFM32_I2C_HIGH_PRIORITY_BURST)
+        {
+            a.highBurst = 0;
+            pw = pn;
+        }
+    }
+    else
+    {
+        a.highBurst = 0;
+    }
+
+    auto w = *pw;
+    *pw = w->next;
+
+    mono_t wait = now - w->since;
+    a.stats.totalWait += wait;
+    if (wait > a.stats.maxWait)
+    {
+        a.stats.maxWait = wait;
+    }
+
+    // the bus remains locked for the new owner
+    a.stats.acquisitions++;
+    a.acquired = now;
+    w->granted = true;
+}
+
+const I2C::ArbiterStatistics& I2C::Statistics() const
+{
+    return s_arbiter[Index()].stats;
+}
+
+void I2C::ResetStatistics()
+{
+    s_arbiter[Index()].stats = {};
+}
+
+/*!
+ * Prepares the bus for addressing the device of the operation,
+ * acquiring the lock first if the operation starts a new transaction
+ */
+async(I2C::_AddressPrepare, Operation op)
 async_def()
 {
-    if (op.start)
+    if (op.start && !op.locked)
     {
         // start a new transaction, acquire the lock first
-        await_acquire(s_locks, BIT(Index()));
+        await(Acquire, Priority::Normal);
         TransactionInit();
     }
 
@@ -117,6 +313,18 @@ async_def()
     auto state = State();
     auto flags = ClearFlags();
 
+    if (!op.start || op.locked)
+    {
+        // an owner that has exceeded its hold time cannot continue while others are waiting
+        auto& a = s_arbiter[Index()];
+        if (a.waiters && !GETBIT(s_slaveListen, Index()) &&
+            MONO_CLOCKS - a.acquired > MonoFromMilliseconds(EFM32_I2C_MAX_HOLD))
+        {
+            DBGERR("Bus held for too long, failing operation");
+            async_return(false);
+        }
+    }
+
     if (op.noAddress)
     {
         // just verify the state
@@ -125,7 +333,6 @@ async_def()
             DBGERR("Bus not after an ACK, cannot continue");
             async_return(false);
         }
-        async_return(true);
     }
     else if (op.start)
     {
@@ -136,11 +343,34 @@ async_def()
             DBGERR("Bus not idle, resetting");
             await(Reset);
         }
+    }
+    else
+    {
+        if (state != BusDataAck)
+        {
+            DBGERR("Bus not after data ACK, cannot restart");
+            async_return(false);
+        }
+    }
 
+    async_return(true);
+}
+async_end
+
+//! Issues the (repeated) START and the address of the operation, must directly follow _AddressPrepare
+void I2C::AddressSend(Operation op)
+{
+    if (op.noAddress)
+    {
+        return;
+    }
+
+    if (op.start)
+    {
         TxClearBuffer();
         RxClearBuffer();
         Abort();
-        flags = ClearFlags();
+        ClearFlags();
 
         DIAG(DIAG_TRANS, "START >> %c %02X", op.read ? 'R' : 'W', op.address);
         Send(op.fullAddress);
@@ -148,21 +378,31 @@ async_def()
     }
     else
     {
-        if (state != BusDataAck)
-        {
-            DBGERR("Bus not after data ACK, cannot restart");
-            async_return(false);
-        }
-
         DIAG(DIAG_TRANS, "REP-START >> %c %02X", op.read ? 'R' : 'W', op.address);
         Start();
         Send(op.fullAddress);
     }
+}
+
+async(I2C::_Address, Operation op)
+async_def()
+{
+    if (!await(_AddressPrepare, op))
+    {
+        async_return(false);
+    }
+
+    if (op.noAddress)
+    {
+        async_return(true);
+    }
+
+    AddressSend(op);
 
     for (;;)
     {
         bool timeout = !await_mask_not_ms(IF, PrepWait(AwaitFlags), 0, I2C_TIMEOUT);
-        flags = ClearFlags();
+        auto flags = ClearFlags();
 
         if (timeout)
         {
@@ -196,6 +436,11 @@ async_end
 async(I2C::_Read, Operation op, char* data)
 async_def(uint32_t wx)
 {
+    if (UseDMA(op.length))
+    {
+        async_return(await(_ReadDMA, op, data));
+    }
+
     if (!await(_Address, op))
     {
         goto fail;
@@ -243,7 +488,7 @@ async_def(uint32_t wx)
 fail:
         DIAG(DIAG_TRANS, "STOP");
         Stop();
-        TransactionCleanup();
+        TransactionEnd(op);
     }
 
     async_return(f.wx);
@@ -253,6 +498,11 @@ async_end
 async(I2C::_Write, Operation op, const char* data)
 async_def(uint32_t wx)
 {
+    if (UseDMA(op.length))
+    {
+        async_return(await(_WriteDMA, op, data));
+    }
+
     if (!await(_Address, op))
     {
         goto fail;
@@ -306,7 +556,7 @@ fail:
             DIAG(DIAG_TRANS, "STOP");
             Stop();
         }
-        TransactionCleanup();
+        TransactionEnd(op);
     }
 
     DIAG(DIAG_TRANS, "DONE");
@@ -314,6 +564,349 @@ fail:
 }
 async_end
 
+/*!
+ * Reads data using the LDMA, waking up the task only once at the end
+ *
+ * The LDMA is armed before the address is sent and all bytes except the last
+ * one are ACK-ed automatically by the peripheral (AUTOACK). The LDMA itself
+ * turns AUTOACK off after reading the second to last byte, while the last
+ * one is still being received, and the LDMA interrupt after the last byte
+ * issues the NACK (and STOP), so the bus timing does not depend on the latency
+ * of the task or the interrupt.
+ */
+async(I2C::_ReadDMA, Operation op, char* data)
+async_def(
+    LDMAChannelHandle dma;
+    LDMADescriptor desc[3];
+    uint32_t wx;
+)
+{
+    f.wx = 0;
+    f.dma = LDMAChannelHandle();
+    if (!await(_AddressPrepare, op))
+    {
+        goto fail;
+    }
+
+    RxClearBuffer();
+    if (op.stop)
+    {
+        SETBIT(s_dmaStop, Index());
+    }
+    else
+    {
+        RESBIT(s_dmaStop, Index());
+    }
+
+    f.dma = LDMA->GetI2CChannel(Index(), LDMAChannel::I2CSignal::RxDataValid, false);
+    if (op.length > 1)
+    {
+        f.desc[0].SetTransfer(&RXDATA, data, op.length - 1, LDMADescriptor::P2M | LDMADescriptor::UnitByte, LDMALink::Next);
+        f.desc[1].SetImmediateWrite(I2C_CTRL_AUTOACK, EFM32_BITMODPTR(false, &CTRL), LDMALink::Next);
+        f.desc[2].SetTransfer(&RXDATA, data + op.length - 1, 1, LDMADescriptor::P2M | LDMADescriptor::UnitByte | LDMADescriptor::SetDone);
+        EFM32_BITSET_REG(CTRL, I2C_CTRL_AUTOACK);
+    }
+    else
+    {
+        f.desc[0].SetTransfer(&RXDATA, data, 1, LDMADescriptor::P2M | LDMADescriptor::UnitByte | LDMADescriptor::SetDone);
+    }
+    f.dma.DoneHandler(GetDelegate(this, &I2C::DMAReceiveHandler));
+    f.dma.EnableDoneInterrupt();
+    f.dma.LinkLoad(f.desc[0]);
+
+    AddressSend(op);
+
+    DIAG(DIAG_READ, "DMA %d%s", op.length, op.stop ? " +STOP" : "");
+
+    for (;;)
+    {
+        // the end of a read without STOP is signaled by the DMA handler
+        bool timeout = !await_mask_not_ms(IF, PrepWait(I2C_IF_BUSERR | I2C_IF_ARBLOST | I2C_IF_NACK | (op.stop ? I2C_IF_MSTOP : I2C_IF_SSTOP)), 0, I2C_TIMEOUT);
+        auto flags = ClearFlags();
+
+        if (timeout)
+        {
+            DBGERR("timeout waiting for DMA read");
+            await(Reset);
+            goto fail;
+        }
+
+        if (flags.nack)
+        {
+            // address NAK == device not present, do not log an error
+            goto fail;
+        }
+
+        if ((op.stop ? flags.masterStop : flags.slaveStop) && !f.dma.IsEnabled())
+        {
+            f.wx = (char*)f.dma.RootDescriptor().Destination() - data;
+            break;
+        }
+
+        if (HandleError(flags))
+        {
+            DBGERR("error during DMA read");
+            goto fail;
+        }
+    }
+
+    f.dma.Release();
+    if (op.stop)
+    {
+        TransactionEnd(op);
+    }
+
+    async_return(f.wx);
+
+fail:
+    EFM32_BITCLR_REG(CTRL, I2C_CTRL_AUTOACK);
+    if (f.dma.IsValid())
+    {
+        f.wx = (char*)f.dma.RootDescriptor().Destination() - data;
+        f.dma.Release();
+    }
+    DIAG(DIAG_TRANS, "STOP");
+    Stop();
+    TransactionEnd(op);
+    async_return(f.wx);
+}
+async_end
+
+//! Called from the LDMA interrupt handler after the last byte of a DMA read
+void I2C::DMAReceiveHandler()
+{
+    // the last byte must not be ACK-ed
+    if (GETBIT(s_dmaStop, Index()))
+    {
+        CMD = I2C_CMD_NACK | I2C_CMD_STOP;
+    }
+    else
+    {
+        CMD = I2C_CMD_NACK;
+        // there is no flag signaling the end of the read, wake up the task
+        // using the slave STOP flag which cannot occur in master mode
+        EFM32_IFS(this) = I2C_IF_SSTOP;
+    }
+}
+
+/*!
+ * Writes data using the LDMA, waking up the task only once at the end
+ *
+ * The LDMA is armed right after the address is queued for transmission.
+ * When the transaction is to be stopped, the peripheral generates the STOP
+ * condition automatically after a NACK (AUTOSN) or after the last byte (AUTOSE),
+ * which the LDMA enables itself once the last byte has been queued, otherwise
+ * the task wakes up after the last byte is transmitted
+ */
+async(I2C::_WriteDMA, Operation op, const char* data)
+async_def(
+    LDMAChannelHandle dma;
+    LDMADescriptor desc[2];
+    uint32_t wx;
+    bool acked;
+)
+{
+    f.wx = 0;
+    f.dma = LDMAChannelHandle();
+    if (!await(_AddressPrepare, op))
+    {
+        goto fail;
+    }
+
+    f.dma = LDMA->GetI2CChannel(Index(), LDMAChannel::I2CSignal::TxFree, false);
+    if (op.stop)
+    {
+        // enabling AUTOSE any earlier would stop the transfer whenever the LDMA falls behind
+        f.desc[0].SetTransfer(data, &TXDATA, op.length, LDMADescriptor::M2P | LDMADescriptor::UnitByte, LDMALink::Next);
+        f.desc[1].SetImmediateWrite(I2C_CTRL_AUTOSE, EFM32_BITMODPTR(true, &CTRL));
+        EFM32_BITSET_REG(CTRL, I2C_CTRL_AUTOSN);
+    }
+    else
+    {
+        f.desc[0].SetTransfer(data, &TXDATA, op.length, LDMADescriptor::M2P | LDMADescriptor::UnitByte);
+    }
+
+    // the address must be queued before the first data byte
+    AddressSend(op);
+    f.dma.LinkLoad(f.desc[0]);
+    f.acked = op.noAddress;
+
+    DIAG(DIAG_WRITE, "DMA %d%s", op.length, op.stop ? " +STOP" : "");
+
+    for (;;)
+    {
+        bool timeout = !await_mask_not_ms(IF, PrepWait(I2C_IF_BUSERR | I2C_IF_ARBLOST | I2C_IF_NACK | (op.stop ? I2C_IF_MSTOP : I2C_IF_TXC)), 0, I2C_TIMEOUT);
+        auto flags = ClearFlags();
+        f.acked |= flags.ack;
+
+        if (timeout)
+        {
+            DBGERR("timeout waiting for DMA write");
+            await(Reset);
+            goto fail;
+        }
+
+        if (flags.nack)
+        {
+            if (!f.acked)
+            {
+                // address NAK == device not present, do not log an error
+                TxClearBuffer();
+                goto fail;
+            }
+
+            // the NACK-ed byte and anything still buffered has not been accepted
+            size_t sent = (const char*)f.dma.RootDescriptor().Source() - data;
+            size_t unsent = TxEmpty() ? 1 : 2;
+            f.wx = sent > unsent ? sent - unsent : 0;
+            DIAG(DIAG_WRITE | DIAG_ACK, "<NAK after %d", f.wx);
+            TxClearBuffer();
+            if (!op.stop)
+            {
+                // the transaction cannot continue after a NACK
+                goto fail;
+            }
+            break;
+        }
+
+        if (op.stop && flags.masterStop && !f.dma.IsEnabled())
+        {
+            f.wx = op.length;
+            break;
+        }
+
+        if (HandleError(flags))
+        {
+            DBGERR("error during DMA write");
+            goto fail;
+        }
+
+        if (!op.stop && flags.complete && !f.dma.IsEnabled())
+        {
+            // make sure the last byte has been ACK-ed before a repeated start
+            if (!await_mask_ms(STATE, _I2C_STATE_STATE_MASK, I2C_STATE_STATE_DATAACK, I2C_TIMEOUT))
+            {
+                DBGERR("timeout waiting for write data ACK");
+                goto fail;
+            }
+            f.wx = op.length;
+            break;
+        }
+    }
+
+    EFM32_BITCLR_REG(CTRL, I2C_CTRL_AUTOSE | I2C_CTRL_AUTOSN);
+    f.dma.Release();
+    if (op.stop)
+    {
+        // the STOP condition has been generated automatically
+        TransactionEnd(op);
+    }
+
+    DIAG(DIAG_TRANS, "DONE");
+    async_return(f.wx);
+
+fail:
+    EFM32_BITCLR_REG(CTRL, I2C_CTRL_AUTOSE | I2C_CTRL_AUTOSN);
+    if (f.dma.IsValid())
+    {
+        f.dma.Release();
+    }
+    if (BusHeld())
+    {
+        DIAG(DIAG_TRANS, "STOP");
+        Stop();
+    }
+    TransactionEnd(op);
+    async_return(f.wx);
+}
+async_end
+
+/*!
+ * Executes a list of segments under a single lock acquisition
+ *
+ * A segment is the first one of a transaction if it is the first in the list or
+ * follows a segment with the FlagStop flag. Subsequent segments of a transaction
+ * are started with a repeated START, unless they have the FlagNoStart flag, in which
+ * case they just continue the previous segment. Only a write can be continued
+ * by another write, segments continuing a read or changing the direction fail.
+ *
+ * When a segment fails, the rest of its transaction is skipped and execution
+ * continues with the next transaction in the list, so transactions for
+ * several devices can be queued in one list
+ */
+async(I2C::Transfer, Message* messages, size_t count, Priority priority)
+async_def(
+    size_t i;
+    uint32_t op;
+    size_t done;
+    bool skip;
+)
+{
+    await(Acquire, priority);
+    TransactionInit();
+
+    f.done = 0;
+    f.skip = false;
+
+    for (f.i = 0; f.i < count; f.i++)
+    {
+        {
+            auto& m = messages[f.i];
+            bool first = f.i == 0 || messages[f.i - 1].IsStop();
+            bool stop = m.IsStop() || f.i + 1 == count;
+
+            if (first)
+            {
+                f.skip = false;
+            }
+            if (f.skip)
+            {
+                m.transferred = 0;
+                continue;
+            }
+
+            if ((m.flags & Message::FlagNoStart) && !first && (m.IsRead() || messages[f.i - 1].IsRead()))
+            {
+                // the last byte of a read has already been NAK-ed, only writes can be continued
+                DBGCL(Index() ? "I2C1" : "I2C0", "segment %d cannot continue the previous one without START", f.i);
+                DIAG(DIAG_TRANS, "STOP");
+                Stop();
+                m.transferred = 0;
+                f.skip = true;
+                continue;
+            }
+
+            DIAG(DIAG_TRANS, "SEGMENT %d: %c %02X %d%s", f.i, m.IsRead() ? 'R' : 'W', m.address, m.length, stop ? " +STOP" : "");
+            f.op = ((m.flags & Message::FlagNoStart) && !first ?
+                Operation(m.IsRead(), stop, m.length) :
+                Operation(m.address, m.IsRead(), first, stop, m.length)).Locked().value;
+        }
+
+        if (messages[f.i].IsRead())
+        {
+            messages[f.i].transferred = await(_Read, Operation(f.op), messages[f.i].data);
+        }
+        else
+        {
+            messages[f.i].transferred = await(_Write, Operation(f.op), messages[f.i].data);
+        }
+
+        if (messages[f.i].transferred == messages[f.i].length)
+        {
+            f.done++;
+        }
+        else
+        {
+            // the failed operation has issued a STOP, the lock is held until the end of the list
+            f.skip = true;
+        }
+    }
+
+    TransactionCleanup();
+    async_return(f.done);
+}
+async_end
+
 bool I2C::HandleError(StateFlags flags)
 {
     if (flags.arbitrationLost || flags.busError || flags.masterStop)
@@ -374,24 +967,32 @@ async_end
 async(I2C::SlaveWait, SlaveRequest request, Timeout timeout)
 async_def(
     Timeout timeout;
-    uint32_t expect, mask;
+    bool yield;
 )
 {
     ASSERT(IEN == 0);
     ASSERT(request != SlaveRequest::None);
     f.timeout = timeout.MakeAbsolute();
 
-    if (await_acquire_timeout(s_locks, BIT(Index()), f.timeout))
+    for (;;)
     {
+        if (!await(Acquire, Priority::Normal, f.timeout))
+        {
+            break;
+        }
+
+        SETBIT(s_slaveListen, Index());
+        ASSERT(!GETBIT(s_custom, Index()));
         Cortex_SetIRQWakeup(IRQn());
         IRQClear();
         IRQEnable();
         // no need to disable deep sleep yet, interrupt will wake us
 
+        f.yield = false;
         for (;;)
         {
             // wait for the right bus state
-            if (!await_mask_not_timeout(IF, PrepWait(I2C_IF_ADDR | I2C_IF_ARBLOST), 0, timeout))
+            if (!await_mask_not_timeout(IF, PrepWait(I2C_IF_ADDR | I2C_IF_ARBLOST), 0, f.timeout))
             {
                 break;
             }
@@ -407,6 +1008,7 @@ async_def(
                 DIAG(DIAG_SLAVE, "SLAVE << %c %02X", GETBIT(addr, 0) ? 'R' : 'W', addr);
                 if (request == SlaveRequest::Any || IsTransmitter() == (request == SlaveRequest::Read))
                 {
+                    RESBIT(s_slaveListen, Index());
                     // must not sleep while communicating
                     PLATFORM_DEEP_SLEEP_DISABLE();
                     async_return(int(GETBIT(addr, 0) ? SlaveRequest::Read : SlaveRequest::Write));
@@ -414,17 +1016,94 @@ async_def(
 
                 NACK();
             }
+            else if (s_arbiter[Index()].waiters)
+            {
+                // don't hold the bus for the whole timeout, let the waiting masters
+                // go first and queue up behind them
+                f.yield = true;
+                break;
+            }
         }
 
-        RESBIT(s_locks, Index());
         IEN = 0;
         IRQDisable();
+        Release();
+        RESBIT(s_slaveListen, Index());
+
+        if (!f.yield)
+        {
+            break;
+        }
     }
 
     async_return(int(SlaveRequest::None));
 }
 async_end
 
+/*!
+ * Receives data written by the master, ACK-ing every byte that fits in the buffer
+ *
+ * The byte that completely fills the buffer is NACK-ed, so the master
+ * knows it cannot write any more. Reception also ends with a STOP or
+ * a repeated START condition.
+ */
+async(I2C::SlaveRead, Buffer data)
+async_def(uint32_t rx)
+{
+    ASSERT(data.Length());
+    if (State() == BusState::BusAddr)
+    {
+        // we must acknowledge the address
+        ACK();
+    }
+
+    for (f.rx = 0; f.rx < data.Length();)
+    {
+        bool timeout = !await_mask_not_ms(IF, PrepWait(AwaitFlagsSlaveRead), 0, I2C_TIMEOUT);
+        auto flags = ClearFlags();
+
+        if (timeout)
+        {
+            DBGERR("timeout waiting for slave RX data");
+            break;
+        }
+
+        if (HandleSlaveArbLost(flags))
+        {
+            break;
+        }
+        if (HandleError(flags))
+        {
+            DBGERR("error waiting for slave RX data");
+            break;
+        }
+
+        while (!RxEmpty() && f.rx < data.Length())
+        {
+            data.Pointer()[f.rx++] = Receive();
+            if (f.rx < data.Length())
+            {
+                DIAG(DIAG_READ | DIAG_ACK, "%02X >ACK", data.Pointer()[f.rx - 1]);
+                ACK();
+            }
+            else
+            {
+                DIAG(DIAG_READ | DIAG_ACK, "%02X >NAK", data.Pointer()[f.rx - 1]);
+                NACK();
+            }
+        }
+
+        if (flags.slaveStop || flags.repeatedStart)
+        {
+            break;
+        }
+    }
+
+    DIAG(DIAG_TRANS, "DONE");
+    async_return(f.rx);
+}
+async_end
+
 async(I2C::_SlaveWrite, const char* data, size_t length)
 async_def(uint32_t wx)
 {
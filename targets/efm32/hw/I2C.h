@@ -14,6 +14,22 @@
 
 #include <hw/CMU.h>
 #include <hw/GPIO.h>
+#include <hw/LDMA.h>
+
+#ifndef EFM32_I2C_DMA_THRESHOLD
+//! Minimum number of bytes for which master reads and writes are performed by the LDMA instead of byte-by-byte, zero disables DMA transfers
+#define EFM32_I2C_DMA_THRESHOLD    4
+#endif
+
+#ifndef EFM32_I2C_HIGH_PRIORITY_BURST
+//! Maximum number of consecutive bus grants to high priority waiters while normal priority ones are waiting
+#define EFM32_I2C_HIGH_PRIORITY_BURST   4
+#endif
+
+#ifndef EFM32_I2C_MAX_HOLD
+//! Time in milliseconds after which operations of a single owner fail if other tasks are waiting for the bus
+#define EFM32_I2C_MAX_HOLD  100
+#endif
 
 #undef I2C
 
@@ -189,6 +205,12 @@ public:
     void IRQDisable() { NVIC_DisableIRQ(IRQn()); }
     void IRQClear() { NVIC_ClearPendingIRQ(IRQn()); }
 
+    //! Installs a custom interrupt handler (e.g. @ref bus::I2CRegisterSlave), the peripheral
+    //! cannot be used for master or slave transactions until @ref ReleaseIRQHandler is called
+    void ClaimIRQHandler(Delegate<void> handler);
+    //! Restores the interrupt handling used by the transactions
+    void ReleaseIRQHandler();
+
     void ClearPending() { CMD = I2C_CMD_CLEARPC; }
     void TxClearBuffer() { CMD = I2C_CMD_CLEARTX; }
     void Continue() { CMD = I2C_CMD_CONT; }
@@ -250,6 +272,72 @@ public:
     //! Continues a write transaction, writing the specified number of bytes to the bus
     async(Write, Span data, bool stop) { return async_forward(_Write, Operation(false, stop, data.Length()), data.Pointer()); }
 
+    //! Priority of a bus access request, see @ref Transfer
+    enum struct Priority : uint8_t
+    {
+        //! Requests are granted the bus in FIFO order
+        Normal,
+        //! Requests are granted the bus before any normal priority requests,
+        //! but only EFM32_I2C_HIGH_PRIORITY_BURST times in a row while normal ones are waiting
+        High,
+    };
+
+    //! Bus arbitration statistics, all times are in MONO_CLOCKS ticks
+    struct ArbiterStatistics
+    {
+        //! Number of times the bus has been acquired
+        uint32_t acquisitions;
+        //! Number of acquisitions that had to wait for another owner
+        uint32_t contended;
+        //! Total time spent waiting for the bus
+        mono_t totalWait;
+        //! Longest time spent waiting for the bus
+        mono_t maxWait;
+        //! Longest time the bus has been held by a single owner
+        mono_t maxHold;
+    };
+
+    //! Gets the bus arbitration statistics of the peripheral
+    const ArbiterStatistics& Statistics() const;
+    //! Resets the bus arbitration statistics of the peripheral
+    void ResetStatistics();
+
+    //! A single segment of a transaction list, see @ref Transfer
+    struct Message
+    {
+        enum Flags : uint8_t
+        {
+            //! Reads data from the device instead of writing
+            FlagRead = 1,
+            //! Continues the previous write segment without a repeated START and address, valid for writes only
+            FlagNoStart = 2,
+            //! Ends the transaction with a STOP condition after this segment
+            FlagStop = 4,
+        };
+
+        uint8_t address;
+        Flags flags;
+        uint16_t length;
+        char* data;
+        //! Number of bytes actually transferred, filled in by @ref Transfer
+        uint16_t transferred;
+
+        bool IsRead() const { return flags & FlagRead; }
+        bool IsStop() const { return flags & FlagStop; }
+
+        //! Creates a segment writing data to the device with the specified address
+        static Message Write(uint8_t address, Span data, Flags flags = Flags(0)) { return { address, flags, uint16_t(data.Length()), (char*)data.Pointer(), 0 }; }
+        //! Creates a segment reading data from the device with the specified address
+        static Message Read(uint8_t address, Buffer data, Flags flags = Flags(0)) { return { address, Flags(flags | FlagRead), uint16_t(data.Length()), data.Pointer(), 0 }; }
+    };
+
+    //! Executes a list of transaction segments under a single lock acquisition
+    //! @returns the number of segments that transferred all their data
+    async(Transfer, Message* messages, size_t count, Priority priority = Priority::Normal);
+    //! Executes a list of transaction segments under a single lock acquisition
+    //! @returns the number of segments that transferred all their data
+    template<size_t n> async(Transfer, Message (&messages)[n], Priority priority = Priority::Normal) { return async_forward(Transfer, messages, n, priority); }
+
     //! Waits for a slave operation request, returns the type of the operation
     async(SlaveWait, SlaveRequest request = SlaveRequest::Any, Timeout timeout = Timeout::Infinite);
     //! Reads data as a response to a write request operation
@@ -266,6 +354,7 @@ private:
         AwaitFlagsNoAck = I2C_IF_BUSERR | I2C_IF_ARBLOST | I2C_IF_RXDATAV | I2C_IF_MSTOP,
         AwaitFlags = AwaitFlagsNoAck | I2C_IF_ACK | I2C_IF_NACK,
         AwaitFlagsSlaveWrite = I2C_IF_BUSERR | I2C_IF_ARBLOST | I2C_IF_SSTOP | I2C_IF_ACK | I2C_IF_NACK,
+        AwaitFlagsSlaveRead = I2C_IF_BUSERR | I2C_IF_ARBLOST | I2C_IF_SSTOP | I2C_IF_RSTART | I2C_IF_RXDATAV,
     };
 
     union Operation
@@ -274,6 +363,11 @@ private:
             : value(address << 25 | read * BIT(24) | stop * BIT(17) | start * BIT(16) | length) {}
         constexpr Operation(bool read, bool stop, uint16_t length)
             : value(read << 24 | BIT(18) | stop * BIT(17) | length) {}
+        explicit constexpr Operation(uint32_t value)
+            : value(value) {}
+
+        //! Gets the same operation for a transaction whose lock has already been acquired
+        constexpr Operation Locked() const { return Operation(value | BIT(19)); }
 
         uint32_t value;
         struct
@@ -282,7 +376,8 @@ private:
             bool start : 1;
             bool stop : 1;
             bool noAddress : 1;
-            uint8_t : 5;
+            bool locked : 1;
+            uint8_t : 4;
             union
             {
                 struct
@@ -295,12 +390,22 @@ private:
         };
     };
 
+    async(_AddressPrepare, Operation op);
+    void AddressSend(Operation op);
     async(_Address, Operation op);
     async(_Read, Operation op, char* data);
     async(_Write, Operation op, const char* data);
+    async(_ReadDMA, Operation op, char* data);
+    async(_WriteDMA, Operation op, const char* data);
+    void DMAReceiveHandler();
+
+    static constexpr bool UseDMA(size_t length) { return EFM32_I2C_DMA_THRESHOLD && length >= EFM32_I2C_DMA_THRESHOLD && length <= LDMADescriptor::MaximumTransferSize; }
     async(_SlaveWrite, const char* data, size_t length);
 
+    async(Acquire, Priority priority, Timeout timeout = Timeout::Infinite);
+    void Release();
     void TransactionInit();
+    void TransactionEnd(Operation op);
     void TransactionCleanup();
     bool HandleError(StateFlags flags);
     bool HandleSlaveArbLost(StateFlags flags);
@@ -308,3 +413,4 @@ private:
 };
 
 DEFINE_FLAG_ENUM(I2C::Flags);
+DEFINE_FLAG_ENUM(I2C::Message::Flags);
@@ -8,26 +8,50 @@
 
 #include <hw/LDMA.h>
 
-LDMAChannelHandle LDMAController::GetChannel(uint32_t srcDef, bool reuse)
+uint32_t LDMAController::s_owned, LDMAController::s_realtime, LDMAController::s_sync;
+
+/*!
+ * Allocates a channel for the specified request source
+ *
+ * Real-time channels are allocated from the lowest index up and use fixed
+ * priority arbitration (the LDMA gives fixed priority to channels below
+ * CTRL.NUMFIXED), bulk channels are allocated from the highest index down
+ * and are arbitrated round-robin. Channels allocated without reuse are owned
+ * exclusively and are never handed out again until released. Reused channels
+ * are shared by everyone asking for the same source and are never released.
+ */
+LDMAChannelHandle LDMAController::GetChannel(uint32_t srcDef, bool reuse, LDMAChannel::Priority priority)
 {
     EnableClock();
 
+    bool realtime = priority == LDMAChannel::Priority::RealTime;
+
     if (reuse)
     {
         for (unsigned i = 0; i < countof(CH); i++)
         {
-            if (REQSEL(i) == srcDef)
+            if (REQSEL(i) == srcDef && !GETBIT(s_owned, i) && GETBIT(s_realtime, i) == realtime)
             {
                 return i;
             }
         }
     }
 
-    for (unsigned i = 0; i < countof(CH); i++)
+    for (unsigned n = 0; n < countof(CH); n++)
     {
+        unsigned i = realtime ? n : countof(CH) - 1 - n;
         if (REQSEL(i) == 0)
         {
             REQSEL(i) = srcDef;
+            if (!reuse)
+            {
+                s_owned |= BIT(i);
+            }
+            if (realtime)
+            {
+                s_realtime |= BIT(i);
+                UpdateFixedPriority();
+            }
             return i;
         }
     }
@@ -36,6 +60,54 @@ LDMAChannelHandle LDMAController::GetChannel(uint32_t srcDef, bool reuse)
     return ~0u;
 }
 
+void LDMAController::ReleaseChannel(unsigned index)
+{
+    // releasing a shared channel would tear it down for all its other users
+    ASSERT(GETBIT(s_owned, index));
+    auto ch = GetChannelByIndex(index);
+    ch.Disable();
+    ch.DisableDoneInterrupt();
+    ch.DoneHandler(Delegate<void>());
+    ch.SourceNone();
+    ch.ClearDone();
+    RESBIT(s_owned, index);
+    if (GETBIT(s_realtime, index))
+    {
+        RESBIT(s_realtime, index);
+        UpdateFixedPriority();
+    }
+}
+
+//! Makes sure all real-time channels are covered by fixed priority arbitration
+void LDMAController::UpdateFixedPriority()
+{
+    unsigned numFixed = s_realtime ? 32 - __builtin_clz(s_realtime) : 0;
+    MODMASK(CTRL, _LDMA_CTRL_NUMFIXED_MASK, numFixed << _LDMA_CTRL_NUMFIXED_SHIFT);
+}
+
+unsigned LDMAController::AllocateSync()
+{
+    for (unsigned i = 0; i < 8; i++)
+    {
+        if (!GETBIT(s_sync, i))
+        {
+            SETBIT(s_sync, i);
+            ClearSync(i);
+            return i;
+        }
+    }
+
+    ASSERT(0);
+    return ~0u;
+}
+
+void LDMAController::ReleaseSync(unsigned bit)
+{
+    ASSERT(GETBIT(s_sync, bit));
+    ClearSync(bit);
+    RESBIT(s_sync, bit);
+}
+
 unsigned LDMAController::FreeChannels()
 {
     EnableClock();
@@ -53,33 +125,442 @@ unsigned LDMAController::FreeChannels()
     return cnt;
 }
 
+uint32_t LDMAController::s_done;
+bool LDMAController::s_irqSetup;
+Delegate<void> LDMAController::s_handlers[DMA_CHAN_COUNT];
+
+/*!
+ * Installs the demultiplexing interrupt handler on the first call and makes sure the IRQ is enabled
+ *
+ * The handler takes the place of Cortex_SetIRQWakeup, every LDMA interrupt
+ * wakes up the core and the scheduler re-evaluates the tasks waiting
+ * for their bits in s_done
+ */
+void LDMAController::IRQSetup()
+{
+    if (!s_irqSetup)
+    {
+        s_irqSetup = true;
+        Cortex_SetIRQHandler(LDMA_IRQn, GetDelegate(this, &LDMAController::IRQHandler));
+        NVIC_ClearPendingIRQ(LDMA_IRQn);
+    }
+
+    NVIC_EnableIRQ(LDMA_IRQn);
+}
+
+/*!
+ * Records completions of all channels in the signal word and dispatches
+ * per-channel handlers
+ *
+ * The flags are cleared immediately, tasks wait for the bits in s_done
+ * and consume only the ones they are interested in, so waiters on different
+ * channels never interfere with each other
+ */
+void LDMAController::IRQHandler()
+{
+    auto flags = IF & IEN;
+    EFM32_IFC(this) = flags;
+
+#ifdef LDMA_IF_ERROR
+    if (flags & LDMA_IF_ERROR)
+    {
+        DBGCL("LDMA", "ERROR: %08X", STATUS);
+        ASSERT(false);
+    }
+#endif
+
+    flags &= BIT(DMA_CHAN_COUNT) - 1;
+    // tasks clear bits using exclusive access, which is cancelled by the interrupt
+    s_done |= flags;
+
+    while (flags)
+    {
+        unsigned i = __builtin_ctz(flags);
+        RESBIT(flags, i);
+        if (auto& handler = s_handlers[i])
+        {
+            handler();
+        }
+    }
+}
+
+uint32_t LDMAController::TakeDoneSignals(uint32_t mask)
+{
+    for (;;)
+    {
+        uint32_t value = __LDREXW(&s_done);
+        if (!(value & mask))
+        {
+            __CLREX();
+            return 0;
+        }
+        if (!__STREXW(value & ~mask, &s_done))
+        {
+            return value & mask;
+        }
+    }
+}
+
 /*!
  * Waits for all the bits in the mask to set their done flag
  *
  * The order in which the bits become set is not important,
  * nor do they have to be set at once, but the wait ends only
  * when all bits have been set at least once
+ *
+ * The DONE interrupts of the channels are left enabled, so the
+ * completions that occur before the next wait are not lost. Stale
+ * completions of previous transfers are discarded when the channel
+ * is armed again using @ref LDMAChannelHandle::LinkLoad
  */
 async(LDMAController::WaitForDoneMask, uint32_t mask)
-async_def()
+async_def(
+    uint32_t remaining;
+)
 {
-    // make sure the IRQ is enabled and configured
-    Cortex_SetIRQWakeup(LDMA_IRQn);
-    NVIC_ClearPendingIRQ(LDMA_IRQn);
-    NVIC_EnableIRQ(LDMA_IRQn);
+    IRQSetup();
 
-    // do not clear the interrupts before waiting,
+    // do not clear the signals before waiting,
     // as some bits may be already set
-
     EFM32_BITSET_REG(IEN, mask);
+
+    f.remaining = mask;
     do
     {
         // wait for any of the remaining bits to become set
-        await_mask_not(IF, IEN & mask, 0);
-        EFM32_BITCLR_REG(IEN, IF & mask);
-        NVIC_ClearPendingIRQ(LDMA_IRQn);
-    } while (IEN & mask);
-
-    EFM32_IFC(this) = mask;
+        await_mask_not(s_done, f.remaining, 0);
+        f.remaining &= ~TakeDoneSignals(f.remaining);
+    } while (f.remaining);
 }
 async_end
+
+void LDMAChannelHandle::EnableDoneInterrupt()
+{
+    LDMA->IRQSetup();
+    EFM32_BITSET_REG(LDMA->IEN, BIT(index));
+}
+
+void LDMAChannelHandle::DisableDoneInterrupt()
+{
+    EFM32_BITCLR_REG(LDMA->IEN, BIT(index));
+}
+
+alignas(16) LDMADescriptor LDMADescriptorArena::s_descriptors[LDMA_DESCRIPTOR_ARENA_SIZE];
+LDMADescriptor* LDMADescriptorArena::s_free;
+uint32_t LDMADescriptorArena::s_fresh, LDMADescriptorArena::s_used, LDMADescriptorArena::s_peak;
+uint32_t LDMADescriptorArena::s_failures, LDMADescriptorArena::s_releases;
+
+//! Atomically increments the counter if it is below the limit, returns the new value or zero on failure
+template<typename T> static T AtomicIncrementBelow(volatile T& counter, uint32_t limit)
+{
+    for (;;)
+    {
+        uint32_t value = sizeof(T) == 2 ? __LDREXH((volatile uint16_t*)&counter) : __LDREXW((volatile uint32_t*)&counter);
+        if (value >= limit)
+        {
+            __CLREX();
+            return 0;
+        }
+        value++;
+        if (!(sizeof(T) == 2 ? __STREXH(value, (volatile uint16_t*)&counter) : __STREXW(value, (volatile uint32_t*)&counter)))
+        {
+            return value;
+        }
+    }
+}
+
+//! Atomically decrements the counter
+template<typename T> static void AtomicDecrement(volatile T& counter)
+{
+    for (;;)
+    {
+        uint32_t value = sizeof(T) == 2 ? __LDREXH((volatile uint16_t*)&counter) : __LDREXW((volatile uint32_t*)&counter);
+        ASSERT(value);
+        value--;
+        if (!(sizeof(T) == 2 ? __STREXH(value, (volatile uint16_t*)&counter) : __STREXW(value, (volatile uint32_t*)&counter)))
+        {
+            return;
+        }
+    }
+}
+
+/*!
+ * Allocates a descriptor from the arena
+ *
+ * Released descriptors are kept in a singly linked list threaded through
+ * their LINK words, descriptors that were never used are handed out
+ * sequentially, so the arena does not require any initialization.
+ *
+ * The exclusive monitor is cleared on every exception entry and return,
+ * so a STREX can never succeed after the list head was modified
+ * by an interrupt handler, which prevents the ABA problem.
+ */
+LDMADescriptor* LDMADescriptorArena::Alloc(Quota& quota)
+{
+    auto used = AtomicIncrementBelow(quota.used, quota.limit);
+    if (!used)
+    {
+        quota.failures++;
+        return NULL;
+    }
+
+    LDMADescriptor* desc;
+    for (;;)
+    {
+        desc = (LDMADescriptor*)__LDREXW((volatile uint32_t*)&s_free);
+        if (!desc)
+        {
+            __CLREX();
+            break;
+        }
+        if (!__STREXW(desc->LINK, (volatile uint32_t*)&s_free))
+        {
+            break;
+        }
+    }
+
+    if (!desc)
+    {
+        if (auto n = AtomicIncrementBelow(s_fresh, countof(s_descriptors)))
+        {
+            desc = &s_descriptors[n - 1];
+        }
+        else
+        {
+            AtomicDecrement(quota.used);
+            quota.failures++;
+            s_failures++;
+            return NULL;
+        }
+    }
+
+    auto total = AtomicIncrementBelow(s_used, countof(s_descriptors));
+    ASSERT(total);
+    // high-water marks are only statistics, races are harmless here
+    if (total > s_peak) { s_peak = total; }
+    if (used > quota.peak) { quota.peak = used; }
+
+    desc->Reset();
+    return desc;
+}
+
+void LDMADescriptorArena::Free(LDMADescriptor* desc, Quota& quota)
+{
+    ASSERT(Contains(desc));
+
+    for (;;)
+    {
+        auto head = __LDREXW((volatile uint32_t*)&s_free);
+        desc->LINK = head;
+        if (!__STREXW((uint32_t)desc, (volatile uint32_t*)&s_free))
+        {
+            break;
+        }
+    }
+
+    AtomicDecrement(quota.used);
+    AtomicDecrement(s_used);
+    s_releases++;
+}
+
+void LDMARing::Start(LDMAChannelHandle dma, volatile const void* source, Buffer buffer, LDMADescriptor::Flags flags)
+{
+    size_t unit = 1 << ((flags & _LDMA_CH_CTRL_SIZE_MASK) >> _LDMA_CH_CTRL_SIZE_SHIFT);
+    size_t units = buffer.Length() / unit;
+    size_t half = units / 2;
+    ASSERT(half && units - half <= LDMADescriptor::MaximumTransferSize);
+
+    this->dma = dma;
+    this->buffer = (char*)buffer.Pointer();
+    this->size = units * unit;
+    this->half = half * unit;
+    this->read = 0;
+    this->consumed = this->written = 0;
+    this->second = false;
+
+    // both halves signal completion, so the amount of data written can be tracked
+    flags = flags | LDMADescriptor::P2M | LDMADescriptor::SetDone;
+    desc[0].SetTransfer(source, this->buffer, half, flags, LDMALink::Next);
+    desc[1].SetTransfer(source, this->buffer + half * unit, units - half, flags, LDMALink::Previous);
+    dma.DoneHandler(GetDelegate(this, &LDMARing::HalfDone));
+    dma.EnableDoneInterrupt();
+    dma.LinkLoad(desc[0]);
+}
+
+void LDMARing::Stop()
+{
+    dma.Disable();
+    while (dma.IsBusy());
+    dma.DisableDoneInterrupt();
+    dma.DoneHandler(Delegate<void>());
+}
+
+//! Called from the LDMA interrupt handler after each half of the ring is filled
+void LDMARing::HalfDone()
+{
+    written += second ? size - half : half;
+    second = !second;
+}
+
+size_t LDMARing::WriteOffset()
+{
+    size_t offset = (char*)dma.RootDescriptor().Destination() - buffer;
+    // DST points past the end of the buffer until the first descriptor is reloaded
+    return offset >= size ? 0 : offset;
+}
+
+Span LDMARing::Available()
+{
+    size_t write = WriteOffset();
+    return Span(buffer + read, (write >= read ? write : size) - read);
+}
+
+void LDMARing::Consume(size_t count)
+{
+    consumed += count;
+    read += count;
+    ASSERT(read <= size);
+    if (read == size)
+    {
+        read = 0;
+    }
+}
+
+/*!
+ * Checks for data lost because the channel lapped the consumer
+ *
+ * Only completed halves are counted, so an overrun is detected at the latest
+ * when the half in which it happened is filled. The counters are free-running,
+ * the difference stays valid even after they wrap around.
+ */
+bool LDMARing::Overrun()
+{
+    if (written - consumed <= size)
+    {
+        return false;
+    }
+
+    auto primask = __get_PRIMASK();
+    __disable_irq();
+    size_t write = WriteOffset();
+    size_t total = written;
+    if ((write >= half) != second)
+    {
+        // the completion of the previous half has not been counted yet
+        total += second ? size - half : half;
+    }
+    consumed = total + (write >= half ? write - half : write);
+    read = write;
+    __set_PRIMASK(primask);
+    return true;
+}
+
+/*!
+ * Appends descriptors to the chain
+ *
+ * Requests are disabled on the channel while the tail is being extended,
+ * so it cannot move past the old tail while we are looking at it. The channel
+ * may already have loaded the old tail, in which case its LINK register
+ * contains the old (empty) link and has to be updated as well. If the channel
+ * has run off the end of the chain already, it is restarted from the first
+ * new descriptor.
+ *
+ * Disabling requests does not hold off software-triggered (STRUCTREQ)
+ * descriptors, so an old tail of that kind may still finish while its link
+ * is being patched. This is detected by checking the channel once more
+ * afterwards, which is reliable only because the new descriptors cannot all
+ * complete while requests are disabled - at least one of them has to be
+ * a transfer waiting for a peripheral request.
+ */
+void LDMAChain::Append(LDMADescriptor* first, LDMADescriptor* last)
+{
+    ASSERT(dma.HasSource());
+    bool triggered = false;
+    for (auto d = first;; d = d->LinkedDescriptor())
+    {
+        // immediate writes and syncs run on load, only a transfer can wait for a request
+        triggered |= d->IsTransfer() && !(d->CTRL & LDMADescriptor::Start);
+        if (d == last)
+        {
+            break;
+        }
+    }
+    ASSERT(triggered);
+
+    last->Link(LDMALink::None);
+
+    auto primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (!tail)
+    {
+        head = current = first;
+        tail = last;
+        dma.LinkLoad(*first);
+    }
+    else
+    {
+        dma.RequestsDisable();
+        while (dma.IsBusy());   // only waits for the unit being transferred
+
+        tail->Link(first);
+        tail = last;
+
+        if (dma.IsEnabled() && !(dma.Channel().LINK & LDMA_CH_LINK_LINK))
+        {
+            // the channel is executing the old tail
+            dma.RootDescriptor().Link(first);
+        }
+
+        if (!dma.IsEnabled())
+        {
+            // the channel is already past the old tail, its completion still has to be seen by the retirer
+            current = first;
+            dma.LinkContinue(*first);
+        }
+
+        dma.RequestsEnable();
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/*!
+ * Retires the head of the chain if the channel has moved past it
+ *
+ * The root LINK register contains the link of the descriptor being executed.
+ * The chain follows the channel from its last known position to the descriptor
+ * with that link, so descriptors with identical LINK words cannot be confused.
+ */
+LDMADescriptor* LDMAChain::Retire()
+{
+    auto desc = head;
+    if (!desc)
+    {
+        return NULL;
+    }
+
+    if (dma.IsEnabled())
+    {
+        auto next = dma.Channel().LINK & LDMA_CH_LINK_LINK ? dma.LinkedDescriptor() : NULL;
+        while (current != tail && current->LinkedDescriptor() != next)
+        {
+            current = current->LinkedDescriptor();
+        }
+
+        if (current == desc)
+        {
+            return NULL;
+        }
+    }
+
+    if (!(head = desc->LinkedDescriptor()))
+    {
+        tail = NULL;
+    }
+    if (current == desc)
+    {
+        current = head;
+    }
+    return desc;
+}
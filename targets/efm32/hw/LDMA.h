@@ -182,6 +182,40 @@ public:
         };
     }
 
+    //! Creates a descriptor to transfer data between two absolute addresses, usable in constant expressions
+    static constexpr LDMADescriptor Transfer(uint32_t source, uint32_t destination, size_t count, Flags flags, LDMALink link = LDMALink::None)
+    {
+        ASSERT(!(((count - 1) << _LDMA_CH_CTRL_XFERCNT_SHIFT) & ~_LDMA_CH_CTRL_XFERCNT_MASK));
+        return {
+            TypeTransfer | flags | ((count - 1) << _LDMA_CH_CTRL_XFERCNT_SHIFT),
+            source,
+            destination,
+            link.value
+        };
+    }
+
+    //! Creates a descriptor to write a value to an absolute address, usable in constant expressions
+    static constexpr LDMADescriptor ImmediateWrite(uint32_t data, uint32_t destination, LDMALink link = LDMALink::None)
+    {
+        return {
+            TypeImmediate,
+            data,
+            destination,
+            link.value
+        };
+    }
+
+    //! Creates a descriptor that sets and clears SYNC bits, then waits until (SYNC & matchEnable) == matchValue
+    static constexpr LDMADescriptor Sync(uint8_t set, uint8_t clear, uint8_t matchValue, uint8_t matchEnable, Flags flags = Flags(0), LDMALink link = LDMALink::None)
+    {
+        return {
+            TypeSync | flags,
+            uint32_t(set | clear << 8),
+            uint32_t(matchValue | matchEnable << 8),
+            link.value
+        };
+    }
+
     //! Checks if the descriptor specified a memory transfer operation
     ALWAYS_INLINE bool IsTransfer() volatile const { return (CTRL & _LDMA_CH_CTRL_STRUCTTYPE_MASK) == TypeTransfer; }
     //! Checks if the descriptor specified an immediate write operation
@@ -220,6 +254,89 @@ public:
 
 DEFINE_FLAG_ENUM(LDMADescriptor::Flags);
 
+//! Sequence of LDMA descriptors linked using relative links, built at compile time
+//! @note Programs not referring to RAM buffers can be declared as constexpr and stay in flash,
+//! programs with variable buffers are copied to RAM and only the addresses are patched
+template<size_t n> struct LDMAProgram
+{
+    LDMADescriptor desc[n];
+
+    //! Gets the number of descriptors in the program
+    static constexpr size_t Length() { return n; }
+    //! Gets the descriptor at the specified position
+    constexpr LDMADescriptor& operator[](size_t index) { return desc[index]; }
+    //! Gets the descriptor at the specified position
+    constexpr const LDMADescriptor& operator[](size_t index) const { return desc[index]; }
+    //! Gets the first descriptor of the program
+    const LDMADescriptor& First() const { return desc[0]; }
+    //! Gets the last descriptor of the program
+    LDMADescriptor& Last() { return desc[n - 1]; }
+
+    //! Links the end of the program to another descriptor, e.g. a program stored in flash
+    //! @note This makes the link absolute, the program must not be moved afterwards
+    void Then(const LDMADescriptor& next) { desc[n - 1].Link((LDMADescriptor*)&next); }
+};
+
+//! Builds an LDMAProgram from the specified steps
+//!
+//! Each step is linked to the following one using LDMALink::Next, the link
+//! of the last step is preserved, allowing the program to end with
+//! LDMALink::None or loop back using one of the relative links
+template<typename... TSteps> constexpr LDMAProgram<sizeof...(TSteps)> LDMASequence(const TSteps&... steps)
+{
+    LDMAProgram<sizeof...(TSteps)> prog = { { steps... } };
+    for (size_t i = 0; i + 1 < sizeof...(TSteps); i++)
+    {
+        prog.desc[i].LINK = LDMALink::Next;
+    }
+    return prog;
+}
+
+#ifndef LDMA_DESCRIPTOR_ARENA_SIZE
+//! Number of descriptors in the shared LDMADescriptorArena
+#define LDMA_DESCRIPTOR_ARENA_SIZE  16
+#endif
+
+//! Fixed-size pool of LDMADescriptors used for building DMA chains
+//! @note Alloc and Free are lock-free and can be used from interrupt handlers
+class LDMADescriptorArena
+{
+public:
+    //! Limits and statistics of descriptor usage by a single owner
+    struct Quota
+    {
+        constexpr Quota(uint16_t limit = LDMA_DESCRIPTOR_ARENA_SIZE) : limit(limit) {}
+
+        uint16_t limit;         //!< Maximum number of descriptors the owner can hold at once
+        uint16_t used = 0;      //!< Number of descriptors currently held by the owner
+        uint16_t peak = 0;      //!< High-water mark of @ref used
+        uint16_t failures = 0;  //!< Number of allocations refused due to exhausted quota or arena
+    };
+
+    //! Allocates a descriptor charged to the specified @ref Quota, returns NULL if either the quota or the arena is exhausted
+    static LDMADescriptor* Alloc(Quota& quota);
+    //! Returns a descriptor previously allocated using the same @ref Quota to the arena
+    static void Free(LDMADescriptor* desc, Quota& quota);
+    //! Checks if the descriptor belongs to the arena
+    static bool Contains(const LDMADescriptor* desc) { return desc >= s_descriptors && desc < s_descriptors + countof(s_descriptors); }
+
+    //! Gets the total number of descriptors in the arena
+    static constexpr size_t Size() { return countof(s_descriptors); }
+    //! Gets the number of descriptors currently allocated
+    static size_t Used() { return s_used; }
+    //! Gets the high-water mark of allocated descriptors
+    static size_t Peak() { return s_peak; }
+    //! Gets the number of allocations refused because the arena was exhausted
+    static size_t Failures() { return s_failures; }
+    //! Gets a reference to a counter that changes every time a descriptor is returned to the arena
+    static const volatile uint32_t& WatchReleases() { return s_releases; }
+
+private:
+    alignas(16) static LDMADescriptor s_descriptors[LDMA_DESCRIPTOR_ARENA_SIZE];
+    static LDMADescriptor* s_free;
+    static uint32_t s_fresh, s_used, s_peak, s_failures, s_releases;
+};
+
 class LDMAChannel : public LDMA_CH_TypeDef
 {
     friend class LDMAController;
@@ -332,6 +449,13 @@ public:
         DestinationDecrement = LDMA_CH_CFG_DSTINCSIGN_NEGATIVE,
     };
 
+    //! Arbitration class of a channel
+    enum struct Priority
+    {
+        Bulk,       //!< Round-robin arbitration, allocated from the highest channel index down
+        RealTime,   //!< Fixed priority arbitration, allocated from the lowest channel index up
+    };
+
 #if ADC_COUNT
     enum struct ADCSignal
     {
@@ -464,7 +588,9 @@ public:
     //! Loads the LDMADescriptor at the address specified by the LINK register of the LDMAChannel represented by this handle
     void LinkLoad();
     //! Loads the specified LDMADescriptor to the LDMAChannel represented by this handle
-    void LinkLoad(LDMADescriptor& dma);
+    void LinkLoad(const LDMADescriptor& dma);
+    //! Loads the specified LDMADescriptor continuing a previous transfer, keeping its pending completion signal
+    void LinkContinue(const LDMADescriptor& dma);
     //! Clears a pending request on the LDMAChannel represented by this handle
     void RequestClear();
 
@@ -488,9 +614,21 @@ public:
     //! Waits for the DONE interrupt flag to be set on the LDMAChannel represented by this handle
     //! @note this flag is set by transfers having the Flags::SetDone flag, not when a transfer simply completes
     async(WaitForDoneFlag);
+    //! Enables the DONE interrupt of the LDMAChannel represented by this handle
+    void EnableDoneInterrupt();
+    //! Disables the DONE interrupt of the LDMAChannel represented by this handle
+    void DisableDoneInterrupt();
+    //! Sets a handler to be called from the LDMA interrupt handler every time the LDMAChannel represented by this handle sets its DONE flag
+    //! @note The DONE interrupt has to be enabled using @ref EnableDoneInterrupt
+    void DoneHandler(Delegate<void> handler);
 
     //! Disables source for the LDMAChannel represented by this handle, allowing software triggered usage only
     ALWAYS_INLINE void SourceNone() { REQSEL() = 0; }
+    //! Checks if the LDMAChannel represented by this handle is triggered by a peripheral request
+    ALWAYS_INLINE bool HasSource() { return REQSEL() != 0; }
+    //! Stops the LDMAChannel represented by this handle and returns it to the allocator
+    //! @note Only channels allocated without reuse can be released
+    void Release();
     //! Configures the LDMAChannel represented by this handle for the specified PRS channel
     ALWAYS_INLINE void SourcePRS(unsigned index) { ASSERT(index <= 1); REQSEL() = LDMAChannel::SourcePRS << 16 | index; }
 #if ADC_COUNT
@@ -532,7 +670,8 @@ class LDMAController : public LDMA_TypeDef
     friend class LDMAChannelHandle;
 
 private:
-    LDMAChannelHandle GetChannel(uint32_t srcDef, bool reuse = true);
+    LDMAChannelHandle GetChannel(uint32_t srcDef, bool reuse, LDMAChannel::Priority priority = LDMAChannel::Priority::Bulk);
+    void UpdateFixedPriority();
 #ifdef LDMAXBAR
     static volatile uint32_t& REQSEL(unsigned index) { return LDMAXBAR->CH[index].REQSEL; }
 #else
@@ -554,42 +693,78 @@ public:
     //! Allocates a LDMAChannelHandle for a software triggered channel
     LDMAChannelHandle GetTriggeredChannel() { return GetChannel(LDMAChannel::SourceNone << 16 | 1, false); }
     //! Allocates a LDMAChannelHandle for the specified PRS channel, optionally reusing a previously allocated channel
-    LDMAChannelHandle GetPRSChannel(unsigned index, bool reuse = true) { return GetChannel(LDMAChannel::SourcePRS << 16 | index, reuse); }
+    LDMAChannelHandle GetPRSChannel(unsigned index, bool reuse = true, LDMAChannel::Priority priority = LDMAChannel::Priority::Bulk) { return GetChannel(LDMAChannel::SourcePRS << 16 | index, reuse, priority); }
 #if ADC_COUNT
     //! Allocates a LDMAChannelHandle for the specified ADC peripheral and signal, optionally reusing a previously allocated channel
-    LDMAChannelHandle GetADCChannel(unsigned index, LDMAChannel::ADCSignal sig, bool reuse = true) { ASSERT(index < ADC_COUNT); return GetChannel((LDMAChannel::SourceADC0 + index) << 16 | uint32_t(sig), reuse); }
+    LDMAChannelHandle GetADCChannel(unsigned index, LDMAChannel::ADCSignal sig, bool reuse = true, LDMAChannel::Priority priority = LDMAChannel::Priority::RealTime) { ASSERT(index < ADC_COUNT); return GetChannel((LDMAChannel::SourceADC0 + index) << 16 | uint32_t(sig), reuse, priority); }
 #endif
 #if IADC_COUNT
     //! Allocates a LDMAChannelHandle for the specified ADC peripheral and signal, optionally reusing a previously allocated channel
-    LDMAChannelHandle GetIADCChannel(unsigned index, LDMAChannel::IADCSignal sig, bool reuse = true) { ASSERT(index < IADC_COUNT); return GetChannel((LDMAChannel::SourceIADC0 + index) << 16 | uint32_t(sig), reuse); }
+    LDMAChannelHandle GetIADCChannel(unsigned index, LDMAChannel::IADCSignal sig, bool reuse = true, LDMAChannel::Priority priority = LDMAChannel::Priority::RealTime) { ASSERT(index < IADC_COUNT); return GetChannel((LDMAChannel::SourceIADC0 + index) << 16 | uint32_t(sig), reuse, priority); }
 #endif
     //! Allocates a LDMAChannelHandle for the specified USART peripheral and signal, optionally reusing a previously allocated channel
-    LDMAChannelHandle GetUSARTChannel(unsigned index, LDMAChannel::USARTSignal sig, bool reuse = true) { ASSERT(index < USART_COUNT); return GetChannel((LDMAChannel::SourceUSART0 + index) << 16 | uint32_t(sig), reuse); }
+    LDMAChannelHandle GetUSARTChannel(unsigned index, LDMAChannel::USARTSignal sig, bool reuse = true, LDMAChannel::Priority priority = LDMAChannel::Priority::Bulk) { ASSERT(index < USART_COUNT); return GetChannel((LDMAChannel::SourceUSART0 + index) << 16 | uint32_t(sig), reuse, priority); }
 #if UART_COUNT
     //! Allocates a LDMAChannelHandle for the specified UART peripheral and signal, optionally reusing a previously allocated channel
-    LDMAChannelHandle GetUARTChannel(uint index, LDMAChannel::UARTSignal sig, bool reuse = true) { ASSERT(index < UART_COUNT); return GetChannel((LDMAChannel::SourceUART0 + index) << 16 | uint32_t(sig), reuse); }
+    LDMAChannelHandle GetUARTChannel(uint index, LDMAChannel::UARTSignal sig, bool reuse = true, LDMAChannel::Priority priority = LDMAChannel::Priority::Bulk) { ASSERT(index < UART_COUNT); return GetChannel((LDMAChannel::SourceUART0 + index) << 16 | uint32_t(sig), reuse, priority); }
 #endif
 #if LEUART_COUNT
     //! Allocates a LDMAChannelHandle for the specified LEUART peripheral and signal, optionally reusing a previously allocated channel
-    LDMAChannelHandle GetLEUARTChannel(unsigned index, LDMAChannel::LEUARTSignal sig, bool reuse = true) { ASSERT(index < LEUART_COUNT); return GetChannel((LDMAChannel::SourceLEUART0 + index) << 16 | uint32_t(sig), reuse); }
+    LDMAChannelHandle GetLEUARTChannel(unsigned index, LDMAChannel::LEUARTSignal sig, bool reuse = true, LDMAChannel::Priority priority = LDMAChannel::Priority::Bulk) { ASSERT(index < LEUART_COUNT); return GetChannel((LDMAChannel::SourceLEUART0 + index) << 16 | uint32_t(sig), reuse, priority); }
 #endif
     //! Allocates a LDMAChannelHandle for the specified I2C peripheral and signal, optionally reusing a previously allocated channel
-    LDMAChannelHandle GetI2CChannel(unsigned index, LDMAChannel::I2CSignal sig, bool reuse = true) { ASSERT(index < I2C_COUNT); return GetChannel((LDMAChannel::SourceI2C0 + index) << 16 | uint32_t(sig), reuse); }
+    LDMAChannelHandle GetI2CChannel(unsigned index, LDMAChannel::I2CSignal sig, bool reuse = true, LDMAChannel::Priority priority = LDMAChannel::Priority::Bulk) { ASSERT(index < I2C_COUNT); return GetChannel((LDMAChannel::SourceI2C0 + index) << 16 | uint32_t(sig), reuse, priority); }
     //! Allocates a LDMAChannelHandle for the specified TIMER peripheral and signal, optionally reusing a previously allocated channel
-    LDMAChannelHandle GetTIMERChannel(unsigned index, LDMAChannel::TIMERSignal sig, bool reuse = true) { ASSERT(index < TIMER_COUNT); return GetChannel((LDMAChannel::SourceTIMER0 + index) << 16 | uint32_t(sig), reuse); }
+    LDMAChannelHandle GetTIMERChannel(unsigned index, LDMAChannel::TIMERSignal sig, bool reuse = true, LDMAChannel::Priority priority = LDMAChannel::Priority::Bulk) { ASSERT(index < TIMER_COUNT); return GetChannel((LDMAChannel::SourceTIMER0 + index) << 16 | uint32_t(sig), reuse, priority); }
 #if VDAC_COUNT
     //! Allocates a LDMAChannelHandle for the specified VDAC peripheral and signal, optionally reusing a previously allocated channel
-    LDMAChannelHandle GetVDACChannel(unsigned index, LDMAChannel::VDACSignal sig, bool reuse = true) { ASSERT(index < VDAC_COUNT); return GetChannel((LDMAChannel::SourceVDAC0 + index) << 16 | uint32_t(sig), reuse); }
+    LDMAChannelHandle GetVDACChannel(unsigned index, LDMAChannel::VDACSignal sig, bool reuse = true, LDMAChannel::Priority priority = LDMAChannel::Priority::RealTime) { ASSERT(index < VDAC_COUNT); return GetChannel((LDMAChannel::SourceVDAC0 + index) << 16 | uint32_t(sig), reuse, priority); }
 #endif
 #if PDM_COUNT
     //! Allocates a LDMAChannelHandle for the specified PDM peripheral and signal, optionally reusing a previously allocated channel
-    LDMAChannelHandle GetPDMChannel(unsigned index, LDMAChannel::PDMSignal sig, bool reuse = true) { ASSERT(index < PDM_COUNT); return GetChannel((LDMAChannel::SourcePDM0 + index) << 16 | uint32_t(sig), reuse); }
+    LDMAChannelHandle GetPDMChannel(unsigned index, LDMAChannel::PDMSignal sig, bool reuse = true, LDMAChannel::Priority priority = LDMAChannel::Priority::RealTime) { ASSERT(index < PDM_COUNT); return GetChannel((LDMAChannel::SourcePDM0 + index) << 16 | uint32_t(sig), reuse, priority); }
 #endif
 
     //! Gets the number of unused channels that can be still allocated
     unsigned FreeChannels();
+    //! Releases a channel allocated using one of the Get*Channel methods
+    void ReleaseChannel(unsigned index);
+    //! Gets the mask of channels that were allocated exclusively (without reuse)
+    static uint32_t OwnedChannels() { return s_owned; }
+    //! Gets the mask of channels that use fixed priority arbitration
+    static uint32_t RealTimeChannels() { return s_realtime; }
     //! Waits for all the channels specified in the mask to set their done flag
     async(WaitForDoneMask, uint32_t mask);
+
+    //! Allocates one of the SYNC trigger bits used by SYNC descriptors to coordinate channels
+    //! @note The SYNC bits are independent of channel indexes, there are only eight of them
+    unsigned AllocateSync();
+    //! Releases a SYNC trigger bit allocated using @ref AllocateSync
+    void ReleaseSync(unsigned bit);
+#ifdef _LDMA_SYNCSWSET_MASK
+    //! Sets the specified SYNC trigger bit
+    void SetSync(unsigned bit) { SYNCSWSET = BIT(bit); }
+    //! Clears the specified SYNC trigger bit
+    void ClearSync(unsigned bit) { SYNCSWCLR = BIT(bit); }
+#else
+    //! Sets the specified SYNC trigger bit
+    void SetSync(unsigned bit) { EFM32_BITSET_REG(SYNC, BIT(bit)); }
+    //! Clears the specified SYNC trigger bit
+    void ClearSync(unsigned bit) { EFM32_BITCLR_REG(SYNC, BIT(bit)); }
+#endif
+
+    //! Gets the word with completion signals of all channels, updated by the LDMA interrupt handler
+    static const volatile uint32_t& DoneSignals() { return s_done; }
+    //! Atomically clears the completion signals specified in the mask, returns the ones that were set
+    static uint32_t TakeDoneSignals(uint32_t mask);
+
+private:
+    static uint32_t s_done, s_owned, s_realtime, s_sync;
+    static bool s_irqSetup;
+    static Delegate<void> s_handlers[DMA_CHAN_COUNT];
+
+    void IRQSetup();
+    void IRQHandler();
 };
 
 ALWAYS_INLINE LDMAChannel& LDMAChannelHandle::Channel() { return *(LDMAChannel*)&LDMA->CH[index]; }
@@ -608,13 +783,15 @@ ALWAYS_INLINE bool LDMAChannelHandle::IsEnabled() const { return GETBIT(LDMA->CH
 
 ALWAYS_INLINE bool LDMAChannelHandle::IsBusy() const { return GETBIT(LDMA->CHBUSY, index); }
 
-ALWAYS_INLINE void LDMAChannelHandle::ClearDone() { EFM32_BITCLR_REG(LDMA->CHDONE, BIT(index)); EFM32_IFC(LDMA) = BIT(index); }
+ALWAYS_INLINE void LDMAChannelHandle::ClearDone() { EFM32_BITCLR_REG(LDMA->CHDONE, BIT(index)); EFM32_IFC(LDMA) = BIT(index); LDMAController::TakeDoneSignals(BIT(index)); }
 ALWAYS_INLINE void LDMAChannelHandle::SetDone() { EFM32_BITSET_REG(LDMA->CHDONE, BIT(index)); EFM32_IFS(LDMA) = BIT(index); }
 ALWAYS_INLINE bool LDMAChannelHandle::IsDone() const { return GETBIT(LDMA->CHDONE, index); }
 
 ALWAYS_INLINE void LDMAChannelHandle::Request() { LDMA->SWREQ = BIT(index); }
-ALWAYS_INLINE void LDMAChannelHandle::LinkLoad(LDMADescriptor& desc) { RootDescriptor().LINK = (uint32_t)&desc; LDMA->LINKLOAD = BIT(index); }
-ALWAYS_INLINE void LDMAChannelHandle::LinkLoad() { LDMA->LINKLOAD = BIT(index); }
+// a new transfer must not be considered complete due to a leftover signal of the previous one
+ALWAYS_INLINE void LDMAChannelHandle::LinkLoad(const LDMADescriptor& desc) { LDMAController::TakeDoneSignals(BIT(index)); LinkContinue(desc); }
+ALWAYS_INLINE void LDMAChannelHandle::LinkContinue(const LDMADescriptor& desc) { RootDescriptor().LINK = (uint32_t)&desc; LDMA->LINKLOAD = BIT(index); }
+ALWAYS_INLINE void LDMAChannelHandle::LinkLoad() { LDMAController::TakeDoneSignals(BIT(index)); LDMA->LINKLOAD = BIT(index); }
 ALWAYS_INLINE void LDMAChannelHandle::RequestClear() { LDMA->REQCLEAR = BIT(index); }
 
 ALWAYS_INLINE void LDMAChannelHandle::RequestsEnable() { EFM32_BITCLR_REG(LDMA->REQDIS, BIT(index)); }
@@ -626,3 +803,86 @@ ALWAYS_INLINE bool LDMAChannelHandle::RequestsPending() const { return GETBIT(LD
 ALWAYS_INLINE LDMAChannelHandle LDMADescriptor::ChannelHandle() volatile const { return ((uintptr_t)this - (uintptr_t)LDMA->CH) / sizeof(LDMA_CH_TypeDef); }
 
 ALWAYS_INLINE async(LDMAChannelHandle::WaitForDoneFlag) { return async_forward(LDMA->WaitForDoneMask, BIT(index)); }
+ALWAYS_INLINE void LDMAChannelHandle::DoneHandler(Delegate<void> handler) { LDMAController::s_handlers[index] = handler; }
+ALWAYS_INLINE void LDMAChannelHandle::Release() { LDMA->ReleaseChannel(index); }
+
+//! Continuous peripheral-to-memory transfer into a circular buffer
+//!
+//! Two descriptors, each covering one half of the buffer, are linked to each
+//! other using relative links, so the channel never stops and never has to be
+//! relinked. The consumer follows the DST register of the channel and is
+//! responsible for keeping up, the ring must be large enough to cover the
+//! worst-case latency of the consumer. Completed halves are counted in the DONE
+//! interrupt of the channel, so the consumer can detect it has been lapped.
+class LDMARing
+{
+public:
+    //! Starts transferring data from the specified peripheral register into the buffer
+    //! @param flags Additional descriptor flags, must specify the transfer unit
+    void Start(LDMAChannelHandle dma, volatile const void* source, Buffer buffer, LDMADescriptor::Flags flags = LDMADescriptor::UnitByte);
+    //! Stops the transfer
+    void Stop();
+
+    //! Gets the channel used by the ring
+    LDMAChannelHandle Channel() const { return dma; }
+    //! Gets the current write offset of the channel in the buffer
+    size_t WriteOffset();
+    //! Gets the contiguous part of the buffer filled since the last call to @ref Consume
+    Span Available();
+    //! Releases the specified number of bytes obtained from @ref Available
+    void Consume(size_t count);
+    //! Checks if the channel has overwritten data that was not consumed yet,
+    //! in which case the unread data is discarded and the consumer continues from the current write offset
+    bool Overrun();
+
+private:
+    LDMAChannelHandle dma;
+    char* buffer;
+    size_t size, half, read;
+    size_t consumed;
+    volatile size_t written;
+    volatile bool second;
+    LDMADescriptor desc[2];
+
+    void HalfDone();
+};
+
+//! Chain of LDMADescriptors executed by a single channel, which can be extended while the channel is running
+//!
+//! The chain keeps track of its head and tail, so appending is O(1) and
+//! the channel never has to be stopped to link more descriptors. Append and
+//! Retire do not block and can be used from interrupt handlers, but only
+//! a single context should manipulate a particular chain.
+//!
+//! Extending the tail relies on holding off the requests of the channel,
+//! so the channel must have a peripheral source and every appended sequence
+//! must contain at least one descriptor that waits for its request.
+class LDMAChain
+{
+public:
+    //! Associates the chain with the specified channel, forgetting all descriptors
+    void Reset(LDMAChannelHandle dma) { this->dma = dma; head = tail = current = NULL; }
+    //! Gets the channel executing the chain
+    LDMAChannelHandle Channel() const { return dma; }
+
+    //! Appends a single descriptor to the chain
+    void Append(LDMADescriptor* desc) { Append(desc, desc); }
+    //! Appends a sequence of already linked descriptors to the chain, starting the channel if it is not running
+    void Append(LDMADescriptor* first, LDMADescriptor* last);
+    //! Removes the oldest descriptor from the chain if the channel is done with it
+    //! @returns the removed descriptor or NULL if there is none
+    LDMADescriptor* Retire();
+
+    //! Gets the oldest descriptor in the chain
+    LDMADescriptor* Head() const { return head; }
+    //! Gets the newest descriptor in the chain
+    LDMADescriptor* Tail() const { return tail; }
+    //! Checks if there are no descriptors in the chain
+    bool IsEmpty() const { return !head; }
+
+private:
+    LDMAChannelHandle dma;
+    LDMADescriptor* head = NULL;
+    LDMADescriptor* tail = NULL;
+    LDMADescriptor* current = NULL;     //!< last known position of the channel in the chain
+};
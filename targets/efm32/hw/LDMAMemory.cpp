@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32/hw/LDMAMemory.cpp
+ */
+
+#include <hw/LDMAMemory.h>
+
+async(LDMAMemory::Copy, void* destination, const void* source, size_t length)
+async_def(
+    Segment segment;
+    Request req;
+)
+{
+    if (length < LDMA_MEMORY_CPU_THRESHOLD)
+    {
+        memcpy(destination, source, length);
+        async_return(length);
+    }
+
+    f.segment = { destination, source, length };
+    f.req.segment = &f.segment;
+    f.req.count = 1;
+    f.req.isFill = false;
+    Submit(f.req);
+    await_signal(f.req.done);
+    async_return(length);
+}
+async_end
+
+async(LDMAMemory::Fill, void* destination, uint8_t value, size_t length)
+async_def(
+    Segment segment;
+    Request req;
+)
+{
+    if (length < LDMA_MEMORY_CPU_THRESHOLD)
+    {
+        memset(destination, value, length);
+        async_return(length);
+    }
+
+    f.segment = { destination, NULL, length };
+    f.req.segment = &f.segment;
+    f.req.count = 1;
+    f.req.fill = value * 0x01010101u;
+    f.req.isFill = true;
+    Submit(f.req);
+    await_signal(f.req.done);
+    async_return(length);
+}
+async_end
+
+/*!
+ * Fills memory with a repeating pattern
+ *
+ * The first copy of the pattern is written by the CPU, the rest
+ * is an overlapping forward copy from the beginning of the destination.
+ * The distance between source and destination is the pattern length,
+ * so the automatically selected unit never exceeds it.
+ */
+async(LDMAMemory::FillPattern, void* destination, Span pattern, size_t length)
+async_def(
+    Segment segment;
+    Request req;
+)
+{
+    ASSERT(pattern.Length());
+
+    if (length < LDMA_MEMORY_CPU_THRESHOLD + pattern.Length())
+    {
+        for (size_t offset = 0; offset < length; offset += pattern.Length())
+        {
+            memcpy((char*)destination + offset, pattern.begin(), std::min(pattern.Length(), length - offset));
+        }
+        async_return(length);
+    }
+
+    memcpy(destination, pattern.begin(), pattern.Length());
+    f.segment = { (char*)destination + pattern.Length(), destination, length - pattern.Length() };
+    f.req.segment = &f.segment;
+    f.req.count = 1;
+    f.req.isFill = false;
+    Submit(f.req);
+    await_signal(f.req.done);
+    async_return(length);
+}
+async_end
+
+async(LDMAMemory::CopySegments, const Segment* segments, size_t count)
+async_def(
+    Request req;
+)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        total += segments[i].length;
+    }
+
+    if (total < LDMA_MEMORY_CPU_THRESHOLD)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            memcpy(segments[i].destination, segments[i].source, segments[i].length);
+        }
+        async_return(total);
+    }
+
+    f.req.segment = segments;
+    f.req.count = count;
+    f.req.isFill = false;
+    Submit(f.req);
+    await_signal(f.req.done);
+    async_return(total);
+}
+async_end
+
+void LDMAMemory::Submit(Request& req)
+{
+    if (!dma.IsValid())
+    {
+        dma = LDMA->GetTriggeredChannel();
+        dma.DoneHandler(GetDelegate(this, &LDMAMemory::DoneHandler));
+        dma.EnableDoneInterrupt();
+    }
+
+    req.next = NULL;
+    req.offset = 0;
+    req.done = false;
+
+    auto primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (tail)
+    {
+        tail->next = &req;
+        tail = &req;
+    }
+    else
+    {
+        head = tail = &req;
+        if (!Program(req))
+        {
+            // empty request
+            head = tail = NULL;
+            req.done = true;
+        }
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/*!
+ * Starts the next chunk of the request on the channel
+ *
+ * @returns false if the request is already complete
+ */
+bool LDMAMemory::Program(Request& req)
+{
+    while (req.count && req.offset == req.segment->length)
+    {
+        req.segment++;
+        req.count--;
+        req.offset = 0;
+    }
+
+    if (!req.count)
+    {
+        return false;
+    }
+
+    auto& seg = *req.segment;
+    auto dst = (char*)seg.destination + req.offset;
+    auto src = req.isFill ? (const char*)&req.fill : (const char*)seg.source + req.offset;
+    size_t remaining = seg.length - req.offset;
+
+    // use the largest unit allowed by the alignment of all addresses and length
+    uintptr_t align = (uintptr_t)dst | remaining | (req.isFill ? 0 : (uintptr_t)src);
+    unsigned shift = (align & 1) ? 0 : (align & 2) ? 1 : 2;
+    size_t units = std::min(remaining >> shift, size_t(LDMADescriptor::MaximumTransferSize));
+
+    auto flags = LDMADescriptor::Flags(shift << _LDMA_CH_CTRL_SIZE_SHIFT) |
+        LDMADescriptor::Start | LDMADescriptor::TransferModeAll | LDMADescriptor::BlockSize64 | LDMADescriptor::SetDone |
+        (req.isFill ? LDMADescriptor::SourceIncrement0 | LDMADescriptor::DestinationIncrement1 : LDMADescriptor::M2M);
+
+    desc.SetTransfer(src, dst, units, flags);
+    req.offset += units << shift;
+    dma.LinkLoad(desc);
+    return true;
+}
+
+//! Called from the LDMA interrupt handler after each chunk completes
+void LDMAMemory::DoneHandler()
+{
+    while (auto req = head)
+    {
+        if (Program(*req))
+        {
+            return;
+        }
+
+        // request complete, continue with the next one
+        head = req->next;
+        if (!head)
+        {
+            tail = NULL;
+        }
+        req->done = true;
+    }
+}
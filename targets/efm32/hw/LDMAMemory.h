@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020 triaxis s.r.o.
+ * Licensed under the MIT license. See LICENSE.txt file in the repository root
+ * for full license information.
+ *
+ * efm32/hw/LDMAMemory.h
+ */
+
+#pragma once
+
+#include <kernel/kernel.h>
+
+#include <base/Span.h>
+
+#include <hw/LDMA.h>
+
+#ifndef LDMA_MEMORY_CPU_THRESHOLD
+//! Operations shorter than this number of bytes are performed directly by the CPU
+#define LDMA_MEMORY_CPU_THRESHOLD   64
+#endif
+
+//! Memory copy and fill operations performed by a software triggered LDMA channel
+//!
+//! Any number of tasks can share a single instance, requests are queued
+//! and executed one after another, the next chunk is always started directly
+//! from the LDMA interrupt handler. The transfer unit is selected automatically
+//! based on the alignment of the addresses and length.
+class LDMAMemory
+{
+public:
+    //! A single segment of a scatter-gather copy
+    struct Segment
+    {
+        void* destination;
+        const void* source;
+        size_t length;
+    };
+
+    //! Copies a block of memory
+    async(Copy, void* destination, const void* source, size_t length);
+    //! Fills a block of memory with the specified byte
+    async(Fill, void* destination, uint8_t value, size_t length);
+    //! Fills a block of memory with a repeating pattern
+    async(FillPattern, void* destination, Span pattern, size_t length);
+    //! Copies all specified segments in one request
+    async(CopySegments, const Segment* segments, size_t count);
+    //! Copies all specified segments in one request
+    template<size_t n> ALWAYS_INLINE async(CopySegments, const Segment (&segments)[n]) { return async_forward(CopySegments, segments, n); }
+
+private:
+    struct Request
+    {
+        Request* next;
+        const Segment* segment;
+        size_t count;
+        size_t offset;
+        uint32_t fill;
+        bool isFill;
+        bool done;
+    };
+
+    LDMAChannelHandle dma;
+    Request* head = NULL;
+    Request* tail = NULL;
+    LDMADescriptor desc;
+
+    void Submit(Request& req);
+    bool Program(Request& req);
+    void DoneHandler();
+};
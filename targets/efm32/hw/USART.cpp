@@ -65,6 +65,8 @@ ALL_LOCS(Rts);
 
 const uint8_t USART::SyncTransferDescriptor::s_zero = 0;
 uint8_t USART::SyncTransferDescriptor::s_discard;
+const uint16_t USART::SyncTransferDescriptor::s_zero16 = 0;
+uint16_t USART::SyncTransferDescriptor::s_discard16;
 
 #ifdef _SILICON_LABS_32B_SERIES_1
 
@@ -117,16 +119,14 @@ res_pair_t USART::BeginSyncTransferImpl(SyncTransferDescriptor* descriptors, siz
     size_t i;
     for (i = 0; i < count - 1; i++)
     {
-        descriptors[i].tx.Destination(&TXDATA);
+        SyncTransferBind(descriptors[i]);
         descriptors[i].tx.Link(&descriptors[i + 1].tx);
-        descriptors[i].rx.Source(&RXDATA);
         descriptors[i].rx.Link(&descriptors[i + 1].rx);
     }
 
-    descriptors[i].tx.Destination(&TXDATA);
+    SyncTransferBind(descriptors[i]);
     descriptors[i].tx.Link(LDMALink::None);
     descriptors[i].tx.DoneInterrupt();
-    descriptors[i].rx.Source(&RXDATA);
     descriptors[i].rx.Link(LDMALink::None);
     descriptors[i].rx.DoneInterrupt();
 
@@ -182,7 +182,7 @@ async_end
 
 static unsigned diff(unsigned a, unsigned b) { return a > b ? a - b : b - a; }
 
-void USART::BaudRate(unsigned baudRate)
+void USART::BaudRate(unsigned baudRate, const char* name, unsigned index)
 {
     uint32_t best = 0, bestOvs = 0, bestDiv = 0;
     auto freq = ClockFrequency();
@@ -221,8 +221,8 @@ void USART::BaudRate(unsigned baudRate)
         }
     }
 
-    DBGL("USART%d: baud rate = %d, %dx oversampling (%.3q%% off %d)",
-        Index(), best, ClockOversampling(bestOvs),
+    DBGL("%s%d: baud rate = %d, %dx oversampling (%.3q%% off %d)",
+        name, index, best, ClockOversampling(bestOvs),
         diff(best, baudRate) * 100000 / baudRate, baudRate);
 
     ClkDiv(bestDiv);
@@ -188,6 +188,14 @@ public:
     void Setup(Flags flags, FlagsEx flagsEx = FlagsEx::_Default) { CTRL = flags; CTRLX = flagsEx; }
     //! Configures the USART framing
     void FrameSetup(Frame frame) { FRAME = frame; }
+    //! Sets the number of data bits in a frame (4 to 16)
+    void DataBits(unsigned bits) { ASSERT(bits >= 4 && bits <= 16); MODMASK(FRAME, _USART_FRAME_DATABITS_MASK, (bits - 3) << _USART_FRAME_DATABITS_SHIFT); }
+    //! Gets the number of data bits in a frame
+    unsigned DataBits() const { return ((FRAME & _USART_FRAME_DATABITS_MASK) >> _USART_FRAME_DATABITS_SHIFT) + 3; }
+    //! Enables or disables swapping of bytes in the TXDOUBLE and RXDOUBLE registers
+    void Byteswap(bool enable) { enable ? EFM32_BITSET_REG(CTRL, USART_CTRL_BYTESWAP) : EFM32_BITCLR_REG(CTRL, USART_CTRL_BYTESWAP); }
+    //! Checks if swapping of bytes in the TXDOUBLE and RXDOUBLE registers is enabled
+    bool Byteswap() const { return CTRL & USART_CTRL_BYTESWAP; }
     //! Sets the fractional clock divider
     void ClkDiv(uint32_t value) { CLKDIV = ((value - ClkDivOne) << _USART_CLKDIV_DIV_SHIFT) & _USART_CLKDIV_DIV_MASK; }
     //! Gets the fractional clock divider
@@ -214,7 +222,7 @@ public:
     unsigned BaudRateUnsafe() { return OutputClock() >> 4; }
 
     //! Sets the baud rate and appropriate oversampling in asynchronous mode
-    void BaudRate(unsigned baudRate);
+    void BaudRate(unsigned baudRate) { BaudRate(baudRate, "USART", Index()); }
     //! Gets the baud rate in asynchronous mode
     unsigned BaudRate() { return OutputClock() / ClockOversampling(); }
 
@@ -346,10 +354,16 @@ public:
     void ReleaseCs() { GPIO->USARTROUTE_CLR[Index()].ROUTEEN = GPIO_USART_ROUTEEN_CSPEN; }
 #endif
 
+    //! Represents a single synchronous transfer step
+    //! @note The *16 variants transfer one frame of 9 to 16 bits per halfword using
+    //! the TXDOUBLE/RXDOUBLE registers, the USART must be configured for such frames.
+    //! Lengths of their buffers are in bytes and must be even.
     struct SyncTransferDescriptor
     {
         static const uint8_t s_zero;
         static uint8_t s_discard;
+        static const uint16_t s_zero16;
+        static uint16_t s_discard16;
 
         LDMADescriptor rx, tx;
 
@@ -385,9 +399,64 @@ public:
             tx.SetTransfer(transmit, NULL, receive.Length(), LDMADescriptor::UnitByte | LDMADescriptor::M2P);
         }
 
-        size_t Length() const { return tx.Count(); }
+        void Transmit16(Span d)
+        {
+            ASSERT(!(d.Length() & 1));
+            rx.SetTransfer((const void*)NULL, &s_discard16, d.Length() >> 1, LDMADescriptor::UnitHalfWord | LDMADescriptor::P2P);
+            tx.SetTransfer(d, NULL, d.Length() >> 1, LDMADescriptor::UnitHalfWord | LDMADescriptor::M2P);
+        }
+
+        void TransmitSame16(const uint16_t* src, size_t count)
+        {
+            rx.SetTransfer((const void*)NULL, &s_discard16, count, LDMADescriptor::UnitHalfWord | LDMADescriptor::P2P);
+            tx.SetTransfer(src, NULL, count, LDMADescriptor::UnitHalfWord | LDMADescriptor::P2P);
+        }
+
+        void Receive16(Buffer d)
+        {
+            ASSERT(!(d.Length() & 1));
+            rx.SetTransfer((const void*)NULL, d.Pointer(), d.Length() >> 1, LDMADescriptor::UnitHalfWord | LDMADescriptor::P2M);
+            tx.SetTransfer(&s_zero16, NULL, d.Length() >> 1, LDMADescriptor::UnitHalfWord | LDMADescriptor::P2P);
+        }
+
+        void ReceiveSame16(volatile uint16_t* dst, size_t count)
+        {
+            rx.SetTransfer((const void*)NULL, dst, count, LDMADescriptor::UnitHalfWord | LDMADescriptor::P2P);
+            tx.SetTransfer(&s_zero16, NULL, count, LDMADescriptor::UnitHalfWord | LDMADescriptor::P2P);
+        }
+
+        void Bidirectional16(Buffer d) { Bidirectional16(d, d); }
+        void Bidirectional16(Span transmit, Buffer receive)
+        {
+            ASSERT(transmit.Length() == receive.Length());
+            ASSERT(!(receive.Length() & 1));
+            rx.SetTransfer((const void*)NULL, receive.Pointer(), receive.Length() >> 1, LDMADescriptor::UnitHalfWord | LDMADescriptor::P2M);
+            tx.SetTransfer(transmit, NULL, receive.Length() >> 1, LDMADescriptor::UnitHalfWord | LDMADescriptor::M2P);
+        }
+
+        //! Checks if the descriptor transfers halfwords
+        bool IsWide() const { return (tx.CTRL & _LDMA_CH_CTRL_SIZE_MASK) == LDMADescriptor::UnitHalfWord; }
+        //! Gets the number of bytes transferred
+        size_t Length() const { return tx.Count() << IsWide(); }
     };
 
+    //! Points the descriptor to the data registers of this USART matching its transfer unit
+    void SyncTransferBind(SyncTransferDescriptor& d)
+    {
+        if (d.IsWide())
+        {
+            // the requests are per frame, two 8-bit frames per halfword would overrun TXDOUBLE
+            ASSERT(DataBits() > 8);
+            d.tx.Destination(&TXDOUBLE);
+            d.rx.Source(&RXDOUBLE);
+        }
+        else
+        {
+            d.tx.Destination(&TXDATA);
+            d.rx.Source(&RXDATA);
+        }
+    }
+
     //! Starts a simple synchronous bidirectional transfer
     LDMAChannelHandle BeginSyncBidirectionalTransfer(Buffer data);
     //! Performs a simple synchronous bidirectional transfer
@@ -413,6 +482,10 @@ public:
     //! Gets the actual clock oversampling value by index
     unsigned ClockOversampling(unsigned index) const { return BYTES(16,8,6,4)[index]; }
 
+protected:
+    //! Sets the baud rate, the name and index only identify the peripheral in the debug output
+    void BaudRate(unsigned baudRate, const char* name, unsigned index);
+
 private:
     RES_PAIR_DECL(BeginSyncTransferImpl, SyncTransferDescriptor* descriptors, size_t count);
 };